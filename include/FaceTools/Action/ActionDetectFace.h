@@ -30,8 +30,10 @@ public:
 
     QString toolTip() const override { return "Register correspondence mask and place facial landmarks.";}
 
-    // Set ulmks specifies the ids of the landmarks to update (if any).
-    static void detect( FM*, const IntSet& ulmks=IntSet());
+    // Set ulmks specifies the ids of the landmarks to update (if any). Returns false if cancelled
+    // during mask registration in which case the model is left aligned but otherwise unchanged.
+    // Set doAlign false if the model has already been aligned (e.g. with ActionAlignModel::align).
+    static bool detect( FM*, const IntSet& ulmks=IntSet(), const CancelFn &cfn=nullptr, bool doAlign=true);
 
 protected:
     void postInit() override;
@@ -44,6 +46,7 @@ private:
     Widget::LandmarksCheckDialog *_cdialog;
     IntSet _ulmks;
     Event _ev;
+    bool _cancelled;
 };  // end class
 
 }}   // end namespace
@@ -34,6 +34,9 @@ protected:
     bool doBeforeAction( Event) override;
     void doAction( Event) override;
     Event doAfterAction( Event) override;
+
+private:
+    bool _cancelled;
 };  // end class
 
 }}   // end namespace
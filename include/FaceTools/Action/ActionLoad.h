@@ -42,9 +42,16 @@ protected:
     void doAction( Event) override;
     Event doAfterAction( Event) override;
 
+signals:
+    void _onLoadedModel( FM*);  // Emitted from the loading threads
+
+private slots:
+    void _doOnLoadedModel( FM*);
+
 private:
     FileIO::LoadFaceModelsHelper *_loadHelper;
     QFileDialog *_dialog;
+    Vis::FV *_lastFV;   // View of the most recently loaded model
 };  // end class
 
 }}   // end namespace
@@ -47,6 +47,7 @@ private:
     static double s_maxc;
     static size_t s_maxi;
     Event _ev;
+    bool _cancelled;
 };  // end class
 
 }}   // end namespaces
@@ -97,7 +97,13 @@ public:
      * to determine which actions can be set ready. Running actions refresh themselves
      * immediately after doAfterAction() returns and before the final onEvent is emitted.
      */
-    bool isWorking() const { return _isWorking;}
+    bool isWorking() const { return !_working.empty();}
+
+    /**
+     * Returns true if this action cannot currently be executed for the given model because
+     * it is already working on it or, if the action is not reentrant, working on any model.
+     */
+    bool isWorking( const FM*) const;
 
     /**
      * Some actions may need the mouse position at time of actioning. This may be different from the
@@ -130,6 +136,7 @@ public:
 signals:
     void onEvent( Event);   // Report to others that state changing event(s) have occurred.
     void onShowHelp( const QString& helpToken);   // Show the given help by passing token (see helpFile).
+    void onProgress( float);    // Proportion [0,1] of doAction completed (may be emitted from a non-GUI thread).
 
 public slots:
     /**
@@ -163,8 +170,10 @@ public slots:
     void refresh( Event e=Event::NONE);
 
     /**
-     * For asynchronous actions, this function is called if the action times out.
-     * The action should stop what it's doing and finish immediately.
+     * For asynchronous actions, this function is called if the action times out (see
+     * FaceActionWorker::setTimeout; there is no timeout by default) after the
+     * worker's cancel token has been cancelled (so cancelFn returns true from then on).
+     * Override to stop work that doesn't poll cancelFn.
      */
     virtual void endNow();
 
@@ -181,6 +190,29 @@ protected:
     void setAsync( bool async);
     bool isAsync() const { return _doasync;}
 
+    /**
+     * Set whether or not this action can run concurrently for different models (false by default).
+     * Only asynchronous actions that do all of their work on workingModel() (rather than the
+     * selected model) and that hold no other state across calls should be made reentrant.
+     */
+    void setReentrant( bool reentrant);
+    bool isReentrant() const { return _reentrant;}
+
+    /**
+     * Returns the model that the current execution of this action is for. This is the model
+     * that was selected when execute() was called and may no longer be the selected model.
+     * Valid from doBeforeAction until doAfterAction returns. Outside of execution, returns
+     * the selected model.
+     */
+    const FM* workingModel() const;
+
+    /**
+     * Returns the cancel function for the current asynchronous execution of this action. It returns
+     * true once the worker is interrupted (e.g. on timing out) and should be passed to long running
+     * operations called from doAction. Returns null if not called from within an asynchronous doAction.
+     */
+    CancelFn cancelFn() const;
+
     /**
      * Returns the client set mouse position. Returns (-1,-1) if not set.
      * Always reset to (-1,-1) after doAfterAction executes.
@@ -255,9 +287,6 @@ protected:
     */
     virtual void restoreState( const UndoState&);   // Has default ERROR implementation!
 
-private slots:
-    void _endExecute( Event);
-
 private:
     QAction _action;
     QString _dname;
@@ -265,8 +294,9 @@ private:
     const QIcon _icon;
     const QKeySequence _keys;
     bool _doasync;
-    bool _isWorking;
-    FaceActionWorker *_worker;
+    bool _reentrant;
+    std::unordered_multiset<const FM*> _working;  // Models currently being worked on (GUI thread only)
+    const FM *_wfm;     // Working model in the GUI thread
     bool _unlocked; // If true, this action is enabled (true by default)
     Event _pevents; // Purge events
     Event _tevents; // Trigger events
@@ -274,6 +304,7 @@ private:
     QPoint _mpos;   // The primed mouse position
 
     void _pinit();
+    void _endExecute( Event, const FM*);
 
     /**
      * FaceActionManager calls _init() on a FaceAction when being added to it. This sets up the internal QAction
@@ -45,9 +45,25 @@ public:
 
     static void close( const FM*);
 
+    // The number of action executions avoided by coalescing events into batches. Debug counter.
+    static size_t numSuppressed() { return get()->_suppressed;}
+    static void resetSuppressed() { get()->_suppressed = 0;}
+
 public slots:
+    /**
+     * Events are not processed immediately but are coalesced into a batch which is processed
+     * once control returns to the event loop (i.e. once per frame). Each action is purged,
+     * refreshed and triggered at most once per batch by the union of the batch's events (less
+     * the events it sent itself). Actions are visited in dependency order - an action that has
+     * been seen to emit events that trigger another action is visited first. If it then starts
+     * running, the dependent action is held back until the running action reports its events
+     * so that the dependent action runs once rather than twice.
+     */
     void doEvent( Event e=Event::NONE);
 
+private slots:
+    void _processBatch();
+
 signals:
     void onUpdateSelected();
     void onShowHelp( const QString&);
@@ -58,8 +74,27 @@ private:
 
     QWidget *_parent;
     std::unordered_set<FaceAction*> _actions;
+    std::vector<FaceAction*> _actionOrder;  // Actions in registration order
     QMutex _closeLock;
 
+    using SentEvent = std::pair<const FaceAction*, Event>;  // Sending action may be null
+    struct Deferral
+    {
+        Event events = Event::NONE; // The events the deferred action was triggered by
+        std::unordered_set<const FaceAction*> awaiting; // Running actions whose events are awaited
+    };  // end struct
+
+    std::vector<SentEvent> _queue;                              // Events in the next batch
+    bool _scheduled;                                            // True if the next batch is scheduled
+    std::unordered_map<FaceAction*, Event> _forced;             // Actions to trigger in the next batch
+    std::unordered_map<FaceAction*, Deferral> _deferred;        // Actions held back for running actions
+    std::unordered_map<const FaceAction*, Event> _emits;        // Events seen to be emitted by each action
+    size_t _suppressed;
+
+    void _schedule();
+    std::vector<FaceAction*> _dependencyOrder() const;
+    static Event _eventsFor( const FaceAction*, const std::vector<SentEvent>&);
+
     FaceActionManager();
     FaceActionManager( const FaceActionManager&) = delete;
     void operator=( const FaceActionManager&) = delete;
@@ -18,24 +18,84 @@
 #ifndef FACE_TOOLS_ACTION_FACE_ACTION_WORKER_H
 #define FACE_TOOLS_ACTION_FACE_ACTION_WORKER_H
 
-#include <FaceTools/FaceTypes.h>
+/**
+ * Runs a FaceAction's doAction on a thread from a pool shared by all actions. Threads are
+ * reused across runs rather than being created for each execution. The pool keeps track of
+ * the number of runs waiting for a free thread (the queue depth) and per action timings
+ * (time spent waiting in the queue and time spent in doAction) for diagnosing where time
+ * goes during cascades of events.
+ */
+
+#include <FaceTools/CancelToken.h>
+#include <QThreadPool>
+#include <QRunnable>
 #include <QTimer>
-#include <QThread>
 #include <QMutex>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 
 namespace FaceTools { namespace Action {
 
 class FaceAction;
 
-class FaceTools_EXPORT FaceActionWorker : public QThread
+class FaceTools_EXPORT FaceActionWorker : public QObject, public QRunnable
 { Q_OBJECT
 public:
-    FaceActionWorker( FaceAction*, Event);
-    virtual ~FaceActionWorker();
+    // Timings (milliseconds) for all runs of a single action since the last reset.
+    struct Timing
+    {
+        Timing() : runs(0), waitMs(0), maxWaitMs(0), runMs(0), maxRunMs(0) {}
+        size_t runs;
+        double waitMs;      // Total time waiting for a thread
+        double maxWaitMs;
+        double runMs;       // Total time in doAction
+        double maxRunMs;
+    };  // end struct
+
+    // Created in the GUI thread for the given action to run on the given model.
+    FaceActionWorker( FaceAction*, Event, const FM*);
+    ~FaceActionWorker() override;
+
+    FaceAction* action() const { return _worker;}
+    Event event() const { return _event;}
+    const FM* model() const { return _fm;}
+
+    // Queue this worker to run on the shared pool. Deleting the worker is the caller's responsibility
+    // and must not happen before onWorkFinished is emitted.
+    void start();
+
+    // Ask the running action to stop early by cancelling the worker's token (e.g. on user request).
+    // Long running work should poll the token (see FaceAction::cancelFn).
+    void requestInterruption() { _token->cancel();}
+
+    // Seconds a worker may run before its token is cancelled and FaceAction::endNow is called.
+    // Zero (the default) means no timeout so interactive actions run until they finish or are
+    // explicitly interrupted. Set a timeout only for batch or headless use.
+    static void setTimeout( int secs) { _s_timeout = std::max( 0, secs);}
+    static int timeout() { return _s_timeout;}
+    bool isInterruptionRequested() const { return _token->isCancelled();}
+    const CancelToken::Ptr& cancelToken() const { return _token;}
+
+    // Returns the worker running on the calling thread or null if not called from within a worker.
+    static FaceActionWorker* current();
 
     // True if at least one user instigated worker is active
     static bool isUserWorking() { return _s_userWorkCount > 0;}
 
+    // The pool shared by all actions. Its maximum thread count can be set by clients.
+    static QThreadPool* pool();
+
+    // The number of workers queued but not yet running and the number running.
+    static int queueDepth() { return _s_queued;}
+    static int numRunning() { return _s_running;}
+
+    // Returns the timings for actions run since the last reset keyed by action debug name.
+    // Synchronous runs of actions are also recorded (with zero wait time) by FaceAction.
+    static std::unordered_map<std::string, Timing> timings();
+    static void resetTimings();
+    static void recordTiming( const FaceAction*, double waitMs, double runMs);
+
 signals:
     void onWorkFinished( Event);
 
@@ -46,16 +106,26 @@ private slots:
     void _doOnTimerInterval();
 
 private:
+    using Clock = std::chrono::steady_clock;
     FaceAction* _worker;
     Event _event;
+    const FM *_fm;
     QTimer *_timer;
     int _tcount;
-    QString _status;
+    QString _status;    // Status shown when the worker was created
+    CancelToken::Ptr _token;
+    Clock::time_point _queuedAt;
 
-    static int _s_userWorkCount;
-    static QMutex _s_mutex;
+    static std::atomic<int> _s_userWorkCount;
+    static std::atomic<int> _s_queued;
+    static std::atomic<int> _s_running;
+    static std::atomic<int> _s_timeout;
+    static QMutex _s_mutex; // Guards the timings
+    static std::unordered_map<std::string, Timing> _s_timings;
 
     void _deleteTimer();
+    FaceActionWorker( const FaceActionWorker&) = delete;
+    void operator=( const FaceActionWorker&) = delete;
 };  // end class
 
 }}   // end namespace
@@ -18,7 +18,7 @@
 #ifndef FACE_TOOLS_ACTION_FACE_MODEL_STATE_H
 #define FACE_TOOLS_ACTION_FACE_MODEL_STATE_H
 
-#include <FaceTools/FaceModel.h>
+#include "MeshSnapshot.h"
 
 namespace FaceTools { namespace Action {
 
@@ -32,6 +32,13 @@ public:
 
     void restore( const Event&) const;   // Called by UndoState
 
+    // The saved mesh (null if the mesh wasn't saved).
+    inline const MeshSnapshot::Ptr& meshSnapshot() const { return _mesh;}
+
+    // Delta encode the saved mesh against the given snapshot (see MeshSnapshot::encode). If encoded, the
+    // saved KD-tree and manifolds are released and are rebuilt with the mesh on restore. Called by UndoState.
+    bool encodeMesh( const MeshSnapshot&);
+
 private:
     FM *_fm;
     bool _metaSaved;
@@ -47,7 +54,7 @@ private:
     int _pethnicity;    // Subject's paternal ethnicity
     QDate _cdate;       // Date of image capture
 
-    r3d::Mesh::Ptr _mesh;
+    MeshSnapshot::Ptr _mesh;
     r3d::KDTree::Ptr _kdtree;
     r3d::Manifolds::Ptr _manifolds;
 
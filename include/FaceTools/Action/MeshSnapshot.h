@@ -0,0 +1,91 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_ACTION_MESH_SNAPSHOT_H
+#define FACE_TOOLS_ACTION_MESH_SNAPSHOT_H
+
+/**
+ * A mesh held by an undo state. Models replace their meshes when the geometry changes (actions
+ * work on deep copies) so the snapshot shares the mesh it was given rather than copying it.
+ * However, FaceModel::addTransformMatrix transforms the model's mesh in place so the snapshot
+ * records the mesh's transform when taken, and if the shared mesh has been transformed since,
+ * mesh() returns a copy having the recorded transform. A snapshot can be delta encoded against
+ * a newer snapshot of the same model having the same vertices, faces and texture, after which
+ * it keeps just the ranges of vertices whose positions differ (and a shared pointer to the newer
+ * mesh as its base) so that a full mesh is only rebuilt when the snapshot is restored.
+ */
+
+#include <FaceTools/FaceModel.h>
+
+namespace FaceTools { namespace Action {
+
+class FaceTools_EXPORT MeshSnapshot
+{
+public:
+    using Ptr = std::shared_ptr<MeshSnapshot>;
+
+    // Share the given mesh.
+    static Ptr create( r3d::Mesh::Ptr);
+
+    // Share the model's current mesh.
+    static Ptr create( const FM*);
+
+    // Return the mesh with the transform it had when the snapshot was taken. This is the shared
+    // mesh itself unless delta encoded (rebuilt from the base) or since transformed (copied).
+    r3d::Mesh::Ptr mesh() const;
+
+    // Return the shared mesh as it is now (null if delta encoded). Its transform may differ from
+    // transform() if it was transformed in place after the snapshot was taken.
+    inline r3d::Mesh::Ptr sharedMesh() const { return _mesh;}
+
+    // The mesh's transform when the snapshot was taken.
+    inline const Mat4f& transform() const { return _tmat;}
+
+    // Returns true iff the snapshot is delta encoded.
+    inline bool isDelta() const { return _base != nullptr;}
+
+    // Delta encode this snapshot against the (not delta encoded) given snapshot. Returns false
+    // without change if either snapshot is already encoded, if they share the same mesh, if the
+    // meshes don't have the same (sequential) vertices, faces and texture, or if so many vertices
+    // differ that encoding wouldn't save memory.
+    bool encode( const MeshSnapshot&);
+
+    // Returns the full mesh held (null if delta encoded) or the base mesh (null if not delta encoded).
+    inline const r3d::Mesh* full() const { return _mesh.get();}
+    inline const r3d::Mesh* base() const { return _base.get();}
+
+    // Approximate bytes of the delta (zero if not delta encoded).
+    size_t deltaBytes() const;
+
+    // Approximate bytes used by the given mesh.
+    static size_t meshBytes( const r3d::Mesh&);
+
+private:
+    r3d::Mesh::Ptr _mesh;               // The full mesh (if not delta encoded)
+    r3d::Mesh::Ptr _base;               // The mesh the delta is against (if delta encoded)
+    Mat4f _tmat;                        // Transform of the mesh when the snapshot was taken
+    std::vector<std::pair<int,int> > _ranges;  // Start vertex ID and count of each run of changed vertices
+    std::vector<Vec3f> _vpos;           // The untransformed positions of the changed vertices (run order)
+
+    explicit MeshSnapshot( r3d::Mesh::Ptr);
+    MeshSnapshot( const MeshSnapshot&) = delete;
+    MeshSnapshot& operator=( const MeshSnapshot&) = delete;
+};  // end class
+
+}}   // end namespaces
+
+#endif
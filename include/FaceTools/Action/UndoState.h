@@ -19,6 +19,7 @@
 #define FACE_TOOLS_ACTION_UNDO_STATE_H
 
 #include "FaceModelState.h"
+#include "MeshSnapshot.h"
 
 namespace FaceTools { namespace Action {
 
@@ -29,6 +30,7 @@ class UndoStates;
  */
 FaceTools_EXPORT void storeUndo( const FaceAction*, Event, bool autoRestore=true);
 FaceTools_EXPORT void scrapLastUndo( const FM*);
+FaceTools_EXPORT Event rollbackLastUndo( const FM*);
 
 
 class FaceTools_EXPORT UndoState
@@ -45,6 +47,15 @@ public:
     // Return the data keyed by the given string (no error checking!).
     QVariant userData( const QString&) const;
 
+    // Set the mesh keyed by the given string. Use instead of setUserData with a deep copy of
+    // the model's mesh. The mesh is shared rather than copied and may be delta encoded against
+    // the mesh saved by the model's next undo state to reduce the memory held by undo states.
+    void setMesh( const QString&, r3d::Mesh::Ptr);
+
+    // Return the mesh keyed by the given string (no error checking!).
+    // If delta encoded, a new mesh is rebuilt on each call.
+    r3d::Mesh::Ptr mesh( const QString&) const;
+
     inline const Event& events() const { return _egrp;}
 
     // Set the name of the undo state (defaults to the action's display name).
@@ -59,6 +70,9 @@ private:
     FM *_sfm;
     std::vector<FaceModelState::Ptr> _fstates;  // The auto restore states (if being used)
     QMap<QString, QVariant> _udata; // The manually set state (if being used)
+    QMap<QString, MeshSnapshot::Ptr> _umeshes;  // Manually set meshes (if being used)
+    size_t _seq;    // Creation order of the state (for evicting the oldest)
+    static size_t s_seq;
 
     UndoState( const FaceAction*, Event, bool);
     UndoState( const UndoState&) = delete;
@@ -69,6 +83,8 @@ private:
     inline const FaceAction* action() const { return _action;}
     Event restore() const;   // Called by UndoStates
     static Ptr create( const FaceAction*, Event, bool autoRestore=false);  // Called by UndoStates
+    std::vector<MeshSnapshot::Ptr> snapshots() const;   // All the held meshes
+    bool encode( const UndoState&); // Delta encode the held meshes against those of the given (newer) state
 
     friend class UndoStates;
 };  // end class
@@ -30,6 +30,20 @@ public:
     // Undo/redo states per model cannot exceeed MAX_RESTORES.
     static const size_t MAX_RESTORES = 10;
 
+    // Default memory budget for all undo/redo states.
+    static const size_t DEFAULT_MEMORY_BUDGET = size_t(2) << 30;   // 2 GiB
+
+    // Set/get the memory budget in bytes for the undo/redo states of all models. Whenever the approximate
+    // memory held by the states exceeds the budget, the oldest undo states (across all models) are evicted
+    // until back within budget (though never the undo state just stored).
+    static void setMemoryBudget( size_t);
+    static size_t memoryBudget();
+
+    // Returns the approximate bytes held by the undo/redo states of the given model or of all models if
+    // null. Meshes shared with a model (or between states) are only counted once and meshes still in use
+    // by their model aren't counted, so this is the memory that would be freed by clearing the states.
+    static size_t memoryUsage( const FM *fm=nullptr);
+
     // Clear the undo/redo stacks for the given model (should happen on save/close).
     static void clear( const FM*);
     static void clear();    // Clear all undo/redos
@@ -42,6 +56,11 @@ public:
     // changing the model (so don't want to undo to a non-modified state).
     static void scrapLastUndo( const FM*);
 
+    // Restore the last undo state stored for the given model then scrap it without adding a redo.
+    // For rolling back the partial changes of an action that was cancelled after storing its undo.
+    // The model must not be locked by the caller. Returns the events to emit for the restore.
+    static Event rollbackLastUndo( const FM*);
+
     static bool canUndo();
     static bool canRedo();
 
@@ -71,13 +90,19 @@ private:
 
     // Undo stacks per model and also a null entry!
     std::unordered_map<const FM*, Stacks> _stacks;
+    size_t _budget;
 
     QReadWriteLock _mutex;
 
+    UndoStates() : _budget( DEFAULT_MEMORY_BUDGET) {}
+    size_t _memoryUsage( const FM*) const;
+    size_t _memoryUsage() const;
+    void _evict( const UndoState*);
     void _clear( const FM*);
     void _clear();
     void _storeUndo( const FaceAction*, Event, bool);
     void _scrapLastUndo( const FM*);
+    Event _rollbackLastUndo( const FM*);
     bool _canUndo( const FM*);
     bool _canRedo( const FM*);
     QString _undoActionName();
@@ -0,0 +1,117 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_BATCH_PROCESSOR_H
+#define FACE_TOOLS_BATCH_PROCESSOR_H
+
+/**
+ * Headless processing of a list of model files. Each model is run through the pipeline
+ * load -> align -> register mask -> transfer landmarks -> measure -> discover phenotypes -> save/CSV
+ * on a fixed pool of worker threads. No viewers or the ModelSelector are used so this can
+ * be driven from command line tools. Each model is locked for writing while being processed
+ * by a worker so models are never touched by more than one thread at a time. Alignment
+ * of textured models renders offscreen so is serialised across workers.
+ */
+
+#include "FaceTypes.h"
+#include <QStringList>
+#include <QMutex>
+#include <atomic>
+
+namespace FaceTools {
+
+class FaceTools_EXPORT BatchProcessor
+{
+public:
+    enum Stage
+    {
+        LOAD,
+        ALIGN,
+        DETECT,     // Mask registration and landmark transfer
+        MEASURE,
+        PHENOTYPES,
+        SAVE,
+        NUM_STAGES
+    };  // end enum
+
+    // Return a printable name for the given stage.
+    static const char* stageName( Stage);
+
+    struct Params
+    {
+        Params();
+        size_t numThreads;  // Worker threads (zero for QThread::idealThreadCount)
+        bool align;         // Align the model before registration
+        bool detect;        // Register the mask, transfer landmarks and align to the mask
+        bool measure;       // Recalculate all measurements
+        bool phenotypes;    // Discover phenotypic indications
+        QString outDir;     // Save models here in the preferred format (not saved if empty)
+        bool writeCSV;      // Write a CSV file per model into outDir
+        int modelDeadline;  // Milliseconds allowed for aligning and registering each model (no limit if negative)
+    };  // end struct
+
+    struct Report
+    {
+        Report();
+        size_t numModels;               // Number of models attempted
+        size_t numFailed;               // Number of models that failed at some stage
+        double elapsed;                 // Wall clock seconds for the whole batch
+        double stageSecs[NUM_STAGES];   // Summed seconds spent in each stage (over all threads)
+        size_t stageCount[NUM_STAGES];  // Number of times each stage was run
+        size_t numPhenotypes;           // Total number of phenotypic indications discovered
+
+        // Successfully processed models per second of wall clock time.
+        double modelsPerSecond() const;
+
+        // Mean per model latency of the given stage in milliseconds.
+        double meanLatency( Stage) const;
+
+        // Print the throughput report.
+        void print( std::ostream&) const;
+    };  // end struct
+
+    explicit BatchProcessor( const Params &p=Params());
+
+    // Process the given files and return the report. Blocks until all files are done.
+    // The required resources (mask, landmarks, metrics, phenotypes, face detector) must
+    // already have been initialised by the caller for the stages being used.
+    const Report& process( const QStringList&);
+
+    // The last generated report.
+    const Report& report() const { return _report;}
+
+    // Filepaths of models that failed in the last call to process with the reasons why.
+    const std::unordered_map<QString, QString>& failed() const { return _failed;}
+
+private:
+    Params _params;
+    Report _report;
+    std::unordered_map<QString, QString> _failed;
+    QMutex _rlock;  // Guards _report and _failed while workers are running
+
+    void _work( const QStringList&, std::atomic<int>&, size_t);
+    void _processFile( const QString&);
+    void _addTiming( Stage, qint64 nsecs);
+    void _setFailed( const QString&, const QString&);
+
+    BatchProcessor( const BatchProcessor&) = delete;
+    void operator=( const BatchProcessor&) = delete;
+};  // end class
+
+}   // end namespace
+
+#endif
@@ -0,0 +1,72 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_CANCEL_TOKEN_H
+#define FACE_TOOLS_CANCEL_TOKEN_H
+
+/**
+ * Cooperative cancellation of long running operations. A token is cancelled explicitly
+ * or once its deadline (if set) has passed. Heavy operations take a CancelFn which they
+ * poll between units of work, stopping early and discarding their partial results when
+ * it returns true. Pass fn() of a token to have it cancel them.
+ */
+
+#include "FaceTypes.h"
+#include <atomic>
+#include <chrono>
+
+namespace FaceTools {
+
+using CancelFn = std::function<bool()>; // Return true to stop
+
+class FaceTools_EXPORT CancelToken : public std::enable_shared_from_this<CancelToken>
+{
+public:
+    using Ptr = std::shared_ptr<CancelToken>;
+
+    // Create a new token with a deadline the given number of milliseconds from now (none if negative).
+    static Ptr create( int msecs=-1);
+
+    // Cancel now.
+    void cancel() { _cancelled = true;}
+
+    // Set the deadline as the given number of milliseconds from now (none if negative).
+    void setDeadline( int msecs);
+
+    // Returns true if cancelled or the deadline has passed.
+    bool isCancelled() const;
+
+    // Returns a function returning isCancelled that keeps this token alive.
+    CancelFn fn() const;
+
+    // Returns true if the given function is set and returns true.
+    static bool isCancelled( const CancelFn &cfn) { return cfn && cfn();}
+
+private:
+    using Clock = std::chrono::steady_clock;
+    std::atomic<bool> _cancelled;
+    std::atomic<bool> _hasDeadline;
+    std::atomic<Clock::rep> _deadline;  // Ticks since the clock's epoch
+
+    CancelToken();
+    CancelToken( const CancelToken&) = delete;
+    void operator=( const CancelToken&) = delete;
+};  // end class
+
+}   // end namespace
+
+#endif
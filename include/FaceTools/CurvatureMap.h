@@ -0,0 +1,102 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_CURVATURE_MAP_H
+#define FACE_TOOLS_CURVATURE_MAP_H
+
+/**
+ * Per vertex normals and principal curvatures of a mesh built in parallel.
+ * Face normals and areas are calculated first, then vertex normals (area weighted)
+ * and principal curvatures (a least squares fit of the second fundamental form to
+ * the normal curvatures along the edges of each vertex's one-ring).
+ * Work is done in blocks of vertices so that progress can be reported and
+ * the build cancelled between blocks. All data are stored in dense arrays
+ * indexed by face or vertex ID (untransformed mesh coordinates).
+ */
+
+#include "CancelToken.h"
+#include <r3d/Mesh.h>
+#include <functional>
+
+namespace FaceTools {
+
+class FaceTools_EXPORT CurvatureMap
+{
+public:
+    using Ptr = std::shared_ptr<CurvatureMap>;
+    using ProgressFn = std::function<void( float)>; // Called with proportion complete in [0,1]
+    using CancelFn = FaceTools::CancelFn;           // Return true to stop the build
+
+    // Build the curvature map for the given mesh. If the cancel function returns true at any point
+    // the build stops and null is returned. The progress function is called from the calling thread.
+    static Ptr create( const r3d::Mesh&, const ProgressFn &pfn=nullptr, const CancelFn &cfn=nullptr);
+
+    // Create a curvature map for the given mesh reusing the data of prev (built from prevMesh) wherever
+    // the local geometry is unchanged. Vertices are matched to those of prevMesh by ID or, if most IDs
+    // were renumbered (e.g. after cropping), by position. Only vertices that are new, have moved, or have
+    // an incident face that was added or removed (i.e. the edited region plus its one-ring border) are
+    // recomputed. If most of the mesh has changed, the map is rebuilt in full. Returns null if cancelled.
+    static Ptr update( const CurvatureMap &prev, const r3d::Mesh &prevMesh, const r3d::Mesh &mesh,
+                       const ProgressFn &pfn=nullptr, const CancelFn &cfn=nullptr);
+
+    // Returns a cancel function that returns true when interruption of the calling thread is requested.
+    // Use from within a FaceAction's doAction to have FaceActionWorker::requestInterruption stop the build.
+    static CancelFn threadInterruptionFn();
+
+    // Face normals (rows indexed by face ID) and face areas.
+    const MatX3f& faceNormals() const { return _fnrms;}
+    float faceArea( int fid) const { return _fareas[fid];}
+
+    // Area weighted vertex normals (rows indexed by vertex ID).
+    const MatX3f& vertexNormals() const { return _vnrms;}
+    Vec3f vertexNormal( int vidx) const { return _vnrms.row(vidx).transpose();}
+
+    // Principal curvature directions and magnitudes with kappa1 >= kappa2.
+    // Curvature is positive where the surface bends away from the vertex normal (e.g. a sphere).
+    Vec3f vertexPC1( int vidx) const { return _pdir1.row(vidx).transpose();}
+    Vec3f vertexPC2( int vidx) const { return _pdir2.row(vidx).transpose();}
+    float kappa1( int vidx) const { return _kp1[vidx];}
+    float kappa2( int vidx) const { return _kp2[vidx];}
+
+    float meanCurvature( int vidx) const { return 0.5f * (_kp1[vidx] + _kp2[vidx]);}
+    float gaussianCurvature( int vidx) const { return _kp1[vidx] * _kp2[vidx];}
+
+    // The number of vertices whose normals and curvature were computed (rather than
+    // copied from a previous map) when this map was created.
+    size_t numComputed() const { return _ncomputed;}
+
+private:
+    MatX3f _fnrms;
+    VecXf _fareas;
+    MatX3f _vnrms;
+    MatX3f _pdir1, _pdir2;
+    VecXf _kp1, _kp2;
+    size_t _ncomputed;
+
+    CurvatureMap() : _ncomputed(0) {}
+    void _allocate( int nf, int nv);
+    bool _build( const r3d::Mesh&, const ProgressFn&, const CancelFn&);
+    void _setFace( const r3d::Mesh&, int fid);
+    void _setVertexNormal( const r3d::Mesh&, int vidx);
+    void _setVertexCurvature( const r3d::Mesh&, int vidx);
+    CurvatureMap( const CurvatureMap&) = delete;
+    void operator=( const CurvatureMap&) = delete;
+};  // end class
+
+}   // end namespace
+
+#endif
@@ -31,7 +31,8 @@ public:
     // Detection uses the Viola and Jones HaarCascades detector to detect 2D features.
     // Provide the initial detection range with d used to scale how closely the camera
     // is positioned to the face based on the detected distance between the eyes e
-    // with the distance formula rng * e/d.
+    // with the distance formula rng * e/d. Unlike FaceFinder2D, instances render through an
+    // offscreen viewer so callers must not use different instances concurrently.
     FaceAlignmentFinder( const r3d::KDTree&, float rng, float d=0.30f);
 
     // Provide the centre point of the model to focus on initially.
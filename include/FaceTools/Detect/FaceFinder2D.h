@@ -33,6 +33,7 @@ public:
     static bool isInit() { return FeaturesDetector::isInit();}
 
     // FeaturesDetector::initialise must have been called already!
+    // Different instances may be used concurrently from different threads.
     bool find( const cv::Mat_<unsigned char> lightMap);  // Looks for face and eyes only
 
     // Get the positions in the view (as proportions of the view size) of the face and eyes.
@@ -51,7 +52,7 @@ private:
     cv::RotatedRect _faceBox;
     cv::RotatedRect _leye, _reye;  // Left and right eye (from viewer's perspective)
     cv::RotatedRect _interPupilSpace;
-    bool _findEyes( const cv::Mat_<unsigned char>);
+    bool _findEyes( const cv::Mat_<unsigned char>, const FeaturesDetector::Result&);
 };  // end class
 
 }}   // end namespace
@@ -20,6 +20,7 @@
 
 #include "FaceTools_Export.h"
 #include <rimg/HaarCascadeDetector.h>
+#include <QMutex>
 
 #define FACE0_MODEL_FILE "haarcascade_frontalface_default.xml"
 #define FACE1_MODEL_FILE "haarcascade_frontalface_alt.xml"
@@ -32,40 +33,68 @@
 
 namespace FaceTools { namespace Detect {
 
+/**
+ * Detects a face and eyes in 2D images using the Haar cascades detectors. Detection state lives
+ * with the instance and results are returned to the caller so separate instances may be used
+ * concurrently. Instances are pooled since loading the cascades is expensive; use get() to check
+ * out a detector which is returned to the pool when the last reference to it is released.
+ */
 class FaceTools_EXPORT FeaturesDetector
 {
 public:
+    using Ptr = std::shared_ptr<FeaturesDetector>;
+
+    // Detected boxes. The eye boxes are relative to the face box.
+    struct Result
+    {
+        cv::Rect faceBox;
+        cv::Rect lEyeBox;
+        cv::Rect rEyeBox;
+    };  // end struct
+
     // Initialise using the Haar Cascades model files from the given directory.
-    // If previously initialised, the existing models will be overwritten.
+    // If previously initialised, the existing pooled detectors are discarded
+    // (detectors currently checked out are deleted when released).
     static bool initialise( const std::string& modelDir);
 
     // Returns true iff the detector was successfully initialised.
-    static bool isInit() { return !s_faceDetectors.empty();}
+    static bool isInit();
 
-    // Try to detect a single face from the given 2D single channel intensity image.
-    // Returns true IFF a face is detected (accessed by getFaceBox()).
-    static bool find( const cv::Mat_<unsigned char> img);
+    // Check out a detector from the pool (creating a new one if none are idle).
+    // Returns null if not initialised.
+    static Ptr get();
 
-    static const cv::Rect& faceBox() { return s_faceBox;}
-    static const cv::Rect& leftEye() { return s_lEyeBox;}
-    static const cv::Rect& rightEye() { return s_rEyeBox;}
+    // Convenience function to check out a detector and call find on it.
+    static bool detect( const cv::Mat_<unsigned char> img, Result&);
+
+    // Try to detect a single face from the given 2D single channel intensity image.
+    // Returns true IFF a face and both eyes are detected with their boxes set in the given result.
+    bool find( const cv::Mat_<unsigned char> img, Result&);
 
 private:
-    static std::vector<rimg::HaarCascadeDetector::Ptr> s_faceDetectors;
-    static std::vector<rimg::HaarCascadeDetector::Ptr> s_eyeDetectors;
-    static cv::Rect s_faceBox;
-    static cv::Rect s_lEyeBox;
-    static cv::Rect s_rEyeBox;
+    std::vector<rimg::HaarCascadeDetector::Ptr> _faceDetectors;
+    std::vector<rimg::HaarCascadeDetector::Ptr> _eyeDetectors;
+    int _gen;   // Initialisation generation this detector was created for
+
+    static std::string s_modelDir;
+    static std::vector<FeaturesDetector*> s_pool;   // Idle detectors
+    static int s_gen;
+    static QMutex s_lock;
 
     // Search for two eyes within the previously found facebox.
-    // (findFace() must be called prior to calling this function).
     // True is returned IFF both the left and right eyes are found.
-    // The x,y coordinates of the eye boxes are with respect to the
-    // face box returned by getFaceBox().
-    static bool findEyes();
+    // The x,y coordinates of the eye boxes are with respect to the face box.
+    bool _findEyes( Result&) const;
+
+    static FeaturesDetector* _create( const std::string&, int);
+    static void _release( FeaturesDetector*);
+
+    FeaturesDetector() : _gen(0) {}
+    ~FeaturesDetector() {}
+    FeaturesDetector( const FeaturesDetector&) = delete;
+    void operator=( const FeaturesDetector&) = delete;
 };  // end class
 
 }}   // end namespaces
 
 #endif
-
@@ -84,6 +84,7 @@ public:
     bool isAligned() const;
 
     const r3d::Mesh& mesh() const { return *_mesh;}
+    std::shared_ptr<const r3d::Mesh> meshPtr() const { return _mesh;}  // Keeps the mesh alive across updates
     const r3d::KDTree& kdtree() const { return *_kdtree;}
     const r3d::Manifolds& manifolds() const { return *_manifolds;}
     bool hasTexture() const { return _mesh->hasMaterials();}
@@ -330,5 +331,6 @@ private:
 }   // end namespace
 
 Q_DECLARE_METATYPE( r3d::Mesh::Ptr)
+Q_DECLARE_METATYPE( FaceTools::FM*)
 
 #endif
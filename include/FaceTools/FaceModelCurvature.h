@@ -18,9 +18,8 @@
 #ifndef FACE_TOOLS_FACE_MODEL_CURVATURE_H
 #define FACE_TOOLS_FACE_MODEL_CURVATURE_H
 
-#include "FaceTypes.h"
-#include <r3d/Curvature.h>
-#include <QReadWriteLock>
+#include "ModelCache.h"
+#include "CurvatureMap.h"
 #include <vtkActor.h>
 #include <vtkFloatArray.h>
 #include <vtkSmartPointer.h>
@@ -30,29 +29,49 @@ namespace FaceTools {
 class FaceTools_EXPORT FaceModelCurvature
 {
 public:
-    using RPtr = std::shared_ptr<const r3d::Curvature>;
-    using WPtr = std::shared_ptr<r3d::Curvature>;
+    using RPtr = std::shared_ptr<const CurvatureMap>;
+    using WPtr = std::shared_ptr<CurvatureMap>;
 
-    // Returns the curvature map for the given model or null if not available.
-    // Read lock is held while returned shared ptr is alive.
+    // Returns the curvature map for the given model or null if not available
+    // or if the model's mesh has changed since the map was made.
+    // The model's read lock is held while returned shared ptr is alive.
     static RPtr rmetrics( const FM*);
 
-    // Returns the curvature map for the given model or null if not available.
-    // Write lock is held while returned shared ptr is alive.
+    // Returns the curvature map for the given model or null if not available
+    // or if the model's mesh has changed since the map was made.
+    // The model's write lock is held while returned shared ptr is alive.
     static WPtr wmetrics( const FM*);
 
     // Delete curvature data associated with the given model.
     static void purge( const FM*);
 
-    // Create and add curvature data for the given model.
-    static void add( const FM*);
+    // Create and add curvature data for the given model. The curvature map is built in parallel
+    // and only published to the cache on completion. If the cancel function returns true
+    // the build is abandoned, nothing is added and false is returned.
+    static bool add( const FM*, const CurvatureMap::ProgressFn &pfn=nullptr,
+                                const CurvatureMap::CancelFn &cfn=nullptr);
+
+    // Bring the curvature data for the given model up to date with its mesh. If the model has
+    // curvature data made from a previous version of its mesh, only the vertices in and bordering
+    // the changed region are recomputed (see CurvatureMap::update). Otherwise this is as add.
+    // Returns false if cancelled in which case any previous curvature data are retained.
+    static bool update( const FM*, const CurvatureMap::ProgressFn &pfn=nullptr,
+                                   const CurvatureMap::CancelFn &cfn=nullptr);
+
+    // Number of lock acquisitions on the curvature cache that had to wait.
+    static size_t contention() { return _cache.contention();}
+    static void resetContention() { _cache.resetContention();}
 
 private:
-    static std::unordered_map<const FM*, r3d::Curvature::Ptr> _metrics;
-    static QReadWriteLock _lock;
+    static ModelCache<CurvatureMap> _cache;
+    static ModelCache<const r3d::Mesh> _meshes; // The meshes the curvature maps were made from
+    static bool _isCurrent( const FM*);
 };  // end class
 
 
+// Create a VTK array of the vertex normals from the given curvature map.
+FaceTools_EXPORT vtkSmartPointer<vtkFloatArray> makeNormals( const CurvatureMap&);
+
 FaceTools_EXPORT vtkSmartPointer<vtkFloatArray> setNormals( vtkActor*, const FM*);
 
 }   // end namespace
@@ -18,28 +18,72 @@
 #ifndef FACE_TOOLS_FACE_MODEL_SYMMETRY_H
 #define FACE_TOOLS_FACE_MODEL_SYMMETRY_H
 
-#include "FaceTypes.h"
-#include <QReadWriteLock>
+#include "ModelCache.h"
+#include <stdexcept>
 
 namespace FaceTools {
 
 class FaceTools_EXPORT FaceModelSymmetry
 {
 public:
-    // Per vertex symmetry stored for the mesh vertices.
-    // Asymmetry values are the signed X, Y, Z, and signed L2 norm.
-    using VtxAsymmMap = std::unordered_map<int, Vec4f>;
-    using RPtr = std::shared_ptr<const VtxAsymmMap>;
+    // Per vertex symmetry stored densely for the mesh vertices as four arrays indexed by vertex ID.
+    // Asymmetry values are the signed X, Y, Z, and signed L2 norm. Vertex IDs are expected to be
+    // sequential (as for models with masks); gaps in the IDs are stored as zero and are not counted
+    // as present (so count and at behave as for the map previously used). Vertices mapping
+    // to a part of the mask without laterally opposite vertices have NaN for all four values.
+    class FaceTools_EXPORT VtxAsymm
+    {
+    public:
+        VtxAsymm() {}
+        explicit VtxAsymm( size_t n);   // Zeroed values for vertex IDs [0,n)
 
-    static RPtr vals( const FM*); // Read lock is held while returned shared ptr is alive.
+        inline size_t size() const { return _v[0].size();}
+
+        // Map compatible accessors.
+        inline size_t count( int vidx) const { return vidx >= 0 && size_t(vidx) < size() ? _has[size_t(vidx)] : 0;}
+        inline Vec4f at( int vidx) const
+        {
+            if ( count(vidx) == 0)
+                throw std::out_of_range( "FaceTools::FaceModelSymmetry::VtxAsymm::at");
+            return Vec4f( _v[0][size_t(vidx)], _v[1][size_t(vidx)], _v[2][size_t(vidx)], _v[3][size_t(vidx)]);
+        }   // end at
+
+        // Return the value of dimension d (0=X, 1=Y, 2=Z, 3=L2) at the given vertex.
+        inline float val( int vidx, int d) const { return _v[d][size_t(vidx)];}
+
+        // Direct access to the contiguous values of dimension d for all vertices.
+        inline const float* data( int d) const { return _v[d].data();}
+
+        inline void set( int vidx, const Vec4f &v)
+        {
+            const size_t i = size_t(vidx);
+            _v[0][i] = v[0];
+            _v[1][i] = v[1];
+            _v[2][i] = v[2];
+            _v[3][i] = v[3];
+            _has[i] = 1;
+        }   // end set
+
+    private:
+        std::vector<float> _v[4];
+        std::vector<uint8_t> _has;  // Bytes rather than bits so different vertices can be set concurrently
+    };  // end class
+
+    using VtxAsymmMap = VtxAsymm;   // For existing clients
+    using RPtr = std::shared_ptr<const VtxAsymm>;
+
+    static RPtr vals( const FM*); // Model's read lock is held while returned shared ptr is alive.
 
     static void add( const FM*);
 
     static void purge( const FM*);
 
+    // Number of lock acquisitions on the symmetry cache that had to wait.
+    static size_t contention() { return _cache.contention();}
+    static void resetContention() { _cache.resetContention();}
+
 private:
-    static std::unordered_map<const FM*, VtxAsymmMap> _vtxSymm;
-    static QReadWriteLock _lock;
+    static ModelCache<VtxAsymm> _cache;
 };  // end class
 
 }   // end namespace
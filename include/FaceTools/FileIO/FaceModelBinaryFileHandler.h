@@ -0,0 +1,81 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_FILE_IO_FACE_MODEL_BINARY_FILE_HANDLER_H
+#define FACE_TOOLS_FILE_IO_FACE_MODEL_BINARY_FILE_HANDLER_H
+
+/**
+ * Binary container alternative to the zipped XML/OBJ 3DF format. The file is a fixed header
+ * followed by a table of sections (vertices, faces, UVs, texture, mask vertices and faces,
+ * landmarks, and the XML metadata) each given as an offset and size. Section data are 16 byte
+ * aligned arrays so the file can be memory mapped and the mesh built directly from the mapped
+ * arrays without extracting to disk or parsing text. Arrays are in the byte order of the writing
+ * machine; the header records a byte order mark and files with a foreign byte order are rejected.
+ * Only the (small) metadata section is XML - the same as written to 3DF files so both formats
+ * hold the same information.
+ */
+
+#include "FaceModelFileHandler.h"
+#include <QThreadStorage>
+
+namespace FaceTools { namespace FileIO {
+
+static const QString BIN_FILE_EXTENSION = "3dfb";
+static const QString BIN_FILE_DESCRIPTION = "3D Face Image and Metadata (Binary)";
+
+class FaceTools_EXPORT FaceModelBinaryFileHandler : public FaceModelFileHandler
+{
+public:
+    static const uint32_t VERSION = 2;
+
+    enum Section : uint32_t
+    {
+        VERTICES = 1,   // float32 x 3 per vertex
+        FACES,          // int32 x 3 per face (indices into VERTICES)
+        UVS,            // float32 x 6 per face (texture coords ordered as the face's vertices)
+        TEXTURE,        // int32 rows, cols, OpenCV type, zero then the continuous pixel data
+        MASK_VERTICES,  // float32 x 3 per mask vertex
+        MASK_FACES,     // int32 x 3 per mask face
+        LANDMARKS,      // int32 assessment ID, landmark ID, FaceSide then float32 x 3 per landmark
+        METADATA        // XML as for 3DF
+    };  // end enum
+
+    FaceModelBinaryFileHandler() { _exts.insert( BIN_FILE_EXTENSION);}
+    QString getFileDescription() const override { return BIN_FILE_DESCRIPTION;}
+    const QStringSet& getFileExtensions() const override { return _exts;}
+
+    bool canRead() const override { return true;}
+    bool canWrite() const override { return true;}
+    bool canWriteTextures() const override { return true;}
+
+    bool canReadConcurrently() const override { return true;}
+
+    QString error() const override { return _err.localData();}
+    double version() const override { return _fversion.localData();}
+
+    FM* read( const QString& filepath) override;
+    bool write( const FM*, const QString& filepath) override;
+
+private:
+    QStringSet _exts;
+    QThreadStorage<QString> _err;       // Per thread so models can be read concurrently
+    QThreadStorage<double> _fversion;   // Metadata version read in
+};  // end class
+
+}}   // end namespaces
+
+#endif
@@ -38,6 +38,10 @@ public:
     virtual bool canWrite() const { return false;}
     virtual bool canWriteTextures() const { return false;}
 
+    // Return true iff read can be called from multiple threads at once. Handlers that do must
+    // keep their per read state (including the string returned by error) local to each thread.
+    virtual bool canReadConcurrently() const { return false;}
+
     // Default implementations cause application exit if not overridden and respective canRead/Write return true.
     virtual FM* read( const QString&);              // Must override if canRead overridden to true
     virtual bool write( const FM*, const QString&); // Must override if canWrite overridden to true
@@ -18,6 +18,13 @@
 #ifndef FACE_TOOLS_FILE_IO_FACE_MODEL_MANAGER_H
 #define FACE_TOOLS_FILE_IO_FACE_MODEL_MANAGER_H
 
+/**
+ * Registry of open models and their file paths. All functions may be called from any thread.
+ * Reads through file handlers that can read concurrently (see FaceModelFileHandler) run in
+ * parallel; reads through other handlers are serialised per handler and all writes are
+ * serialised (writing may render thumbnails). Errors are recorded per calling thread.
+ */
+
 #include "FaceModelFileHandlerMap.h"
 
 namespace FaceTools { namespace FileIO {
@@ -63,14 +70,16 @@ public:
     // Returns true iff the file matching the given filepath is already open.
     static bool isOpen( const QString&);
 
-    // Load in a model (returning null on fail). Also returns null if model already open.
+    // Load in a model (returning null on fail). Also returns null if model already open
+    // or currently being read in by another thread.
     static FM* read( const QString&);
 
-    // Get the nature of the error if read returns null or write returns false.
-    static const QString& error() { return _err;}
+    // Get the nature of the error if read returns null or write returns false
+    // (for the last call to either made from the calling thread).
+    static const QString& error();
 
     // Return the filepath for the model.
-    static const QString& filepath( const FM*);
+    static QString filepath( const FM*);
 
     // Return the open model for the given filepath or null if not open.
     static FM* model( const QString&);
@@ -79,11 +88,11 @@ public:
     static void close( const FM*);
 
     // Returns the number of models currently open.
-    static size_t numOpen() { return _mdata.size();}
+    static size_t numOpen();
     static size_t loadLimit() { return _loadLimit;}  // Load limit not enforced by FaceModelManager (clients must do this)
 
-    // Get the complete set of models currently open.
-    static const FMS& opened() { return _models;}
+    // Get (a copy of) the complete set of models currently open.
+    static FMS opened();
 
     static void printFormats( std::ostream&);    // Prints the accepted file formats
 
@@ -93,7 +102,7 @@ private:
     static FMS _models;
     static std::unordered_map<FM*, QString> _mdata;
     static std::unordered_map<QString, FM*> _mfiles;    // Lookup models by current filepath
-    static QString _err;
+    static QStringSet _loading;                         // Filepaths of models being read in
     static void _setModelFilepath( const FM*, const QString&);
 };  // end class
 
@@ -19,6 +19,7 @@
 #define FACE_TOOLS_FILE_IO_FACE_MODEL_XML_FILE_HANDLER_H
 
 #include "FaceModelFileHandler.h"
+#include <QThreadStorage>
 #include <QTemporaryDir>
 
 namespace FaceTools { namespace FileIO {
@@ -38,16 +39,18 @@ public:
     bool canWrite() const override { return true;}
     bool canWriteTextures() const override { return true;}
 
-    QString error() const override { return _err;}
-    double version() const override { return _fversion;}
+    bool canReadConcurrently() const override { return true;}
+
+    QString error() const override { return _err.localData();}
+    double version() const override { return _fversion.localData();}
 
     FM* read( const QString& filepath) override;
     bool write( const FM*, const QString& filepath) override;
 
 private:
     QStringSet _exts;
-    QString _err;
-    double _fversion;   // File version read in
+    QThreadStorage<QString> _err;       // Per thread so models can be read concurrently
+    QThreadStorage<double> _fversion;   // File version read in
 };  // end class
 
 
@@ -55,6 +58,11 @@ private:
 // Returns a non-empty string on error which contains the nature of the error.
 FaceTools_EXPORT QString readMeta( const QString &fname, QTemporaryDir &extractDir, PTree &tree);
 
+// Read just the meta data from a 3DF file into the given property tree. Only the XML entry
+// is decompressed (in memory) so this is much faster than the above if the mesh isn't needed.
+// Returns a non-empty string on error which contains the nature of the error.
+FaceTools_EXPORT QString readMeta( const QString &fname, PTree &tree);
+
 // Import metadata from a property tree for the given model, setting file
 // version and the mesh and mask filenames and returning true iff successful.
 FaceTools_EXPORT bool importMetaData( FM&, const PTree&, double &fversion, QString &meshfname, QString &maskfname);
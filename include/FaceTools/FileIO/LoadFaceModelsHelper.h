@@ -21,6 +21,7 @@
 #include <FaceTools/FaceTypes.h>
 #include <FaceTools/FaceViewSet.h>
 #include <QWidget>
+#include <functional>
 
 namespace FaceTools { namespace FileIO {
 
@@ -39,11 +40,13 @@ public:
     // Returns the list of filenames to attempt to load in the next call to loadModels.
     const QStringList& filenames() const { return _filenames;}
 
-    // Loads the models set by the last call to setFilteredFilenames and returns the number
-    // successfully loaded. Load errors can be displayed afterwards using showLoadErrors().
+    // Loads the models set by the last call to setFilteredFilenames (concurrently using a
+    // ParallelModelLoader) and returns the number successfully loaded. Load errors can be displayed afterwards using showLoadErrors().
+    // If given, onLoaded is called with each model as soon as it is ready (on the loading thread and
+    // possibly concurrently) so clients can use models while others are still loading.
     // Call lastLoaded() to return the set of loaded models as newly created FaceViews.
     // The internal list of filenames to load is cleared before this function returns.
-    size_t loadModels();
+    size_t loadModels( const std::function<void(FM*)> &onLoaded=nullptr);
 
     // Convenience function to load a single model from filename.
     bool loadModel( const QString& filename);
@@ -0,0 +1,59 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_FILE_IO_PARALLEL_MODEL_LOADER_H
+#define FACE_TOOLS_FILE_IO_PARALLEL_MODEL_LOADER_H
+
+/**
+ * Reads in many models at once through FaceModelManager using a bounded pool of worker threads.
+ * Each file is taken through the whole load pipeline (decompression, parsing, building the mesh
+ * manifolds and KD-tree, and setting bounds) on one worker, and the model is emitted from that
+ * worker as soon as it is ready so clients can start on it while other files are still loading.
+ * Connect with Qt::DirectConnection to handle models on the worker threads themselves.
+ */
+
+#include "FaceModelManager.h"
+#include <QObject>
+#include <atomic>
+
+namespace FaceTools { namespace FileIO {
+
+class FaceTools_EXPORT ParallelModelLoader : public QObject
+{ Q_OBJECT
+public:
+    // Use at most maxThreads workers (QThread::idealThreadCount if zero).
+    explicit ParallelModelLoader( size_t maxThreads=0);
+
+    // Load the models at the given filepaths, blocking until all have been read in or failed.
+    // Returns the number of models successfully loaded (each of which was emitted by loadedModel).
+    size_t load( const QStringList& fpaths);
+
+    // Files not yet started when this is called are skipped. Can be called from any thread.
+    void cancel() { _cancelled = true;}
+
+signals:
+    void loadedModel( FM*);
+    void failedModel( const QString& fpath, const QString& err);
+
+private:
+    const size_t _maxThreads;
+    std::atomic<bool> _cancelled;
+};  // end class
+
+}}   // end namespace
+
+#endif
@@ -18,7 +18,7 @@
 #ifndef FACE_TOOLS_MASK_REGISTRATION_H
 #define FACE_TOOLS_MASK_REGISTRATION_H
 
-#include "FaceTypes.h"
+#include "CancelToken.h"
 #include <r3d/Mesh.h>
 #include <QReadWriteLock>
 
@@ -37,7 +37,7 @@ public:
     static void unsetMask();
 
     // Returns true iff the mask is loaded. Returns false if the model is
-    // currently in the middle of being loaded.
+    // currently in the middle of being loaded. Never blocks.
     static bool maskLoaded();
 
     // Returns the currently set mask path.
@@ -46,9 +46,11 @@ public:
     // Returns the hash of the mask mesh.
     static size_t maskHash();
 
+    // Snapshot of the loaded mask. Snapshots are immutable once published and own their mask model.
     struct MaskData
     {
         MaskData();
+        ~MaskData();
         const FM *mask;
         QString path;   // Filepath
         size_t hash;    // Mesh hash
@@ -63,19 +65,39 @@ public:
         std::unordered_map<int, int> oppVtxs;  // Map of laterally opposite vertex IDs
         IntSet medialVtxs;  // Medial (centreline) vertices
         IntSet q0, q1, q2, q3;  // Quadrant vertices (top left lateral, top right lateral, bottom right, bottom left)
+
+        // Dense versions of the above indexed by mask vertex ID (mask vertex IDs are sequential).
+        // Prefer these for per vertex lookups. Flags give exactly the membership of the sets above
+        // so vertices only reached as the opposite of another vertex have no quadrant flags set.
+        enum VertexFlag : uint8_t { Q0 = 1, Q1 = 2, Q2 = 4, Q3 = 8, MEDIAL = 16};
+        std::vector<int> opposite;      // Laterally opposite vertex IDs
+        std::vector<uint8_t> vflags;    // Bitwise OR of VertexFlag values
+        bool inQuadrant( int vidx, int q) const { return (vflags[vidx] & (1 << q)) != 0;}
+        bool isMedial( int vidx) const { return (vflags[vidx] & MEDIAL) != 0;}
+
+    private:
+        MaskData( const MaskData&) = delete;
+        void operator=( const MaskData&) = delete;
     };  // end struct
 
     using MaskPtr = std::shared_ptr<const MaskData>;
 
-    // Return the read locked mask data which is released
-    // when all shared copies of the returned pointer die.
+    // Return the current snapshot of the mask data (never null but with a null mask if no mask is loaded).
+    // No locks are held; setting a new mask atomically swaps in a new snapshot without disturbing readers
+    // and the returned snapshot (and its mask model) remains valid for as long as the pointer is alive.
     static MaskPtr maskData();
 
     // Algorithm parameters (defaults shown)
     struct FaceTools_EXPORT Params
     {
         Params();
-        size_t k;               // 3
+
+        // Presets for the multi-threaded registration trading accuracy for speed.
+        static Params fast();       // Mostly on a coarse target with smaller smoothing neighbourhoods
+        static Params standard();   // The default number of iterations mostly on coarser targets
+        static Params precise();    // More update and inlier iterations all at full resolution
+
+        size_t k;               // 3 (closest target points per push correspondence)
         float flagThresh;       // 0.9f
         bool eqPushPull;        // false
         float kappa;            // 4.0f
@@ -88,22 +110,57 @@ public:
         size_t numElasticStart; // 100
         size_t numElasticEnd;   // 1
         size_t numUpdateIts;    // 20 (higher for diminishing returns)
+        bool parallel;          // false (true for ViscoElasticRegistration rather than rNonRigid)
+
+        // Coarse to fine schedule. Each level registers against the target sub-sampled on a grid
+        // (see subsampleVertices) and levels are run in order before numUpdateIts at full resolution.
+        // Give levels from coarsest (largest cell size) to finest. The multi-threaded registration
+        // anneals its smoothing over the iterations of all levels; rNonRigid anneals within each.
+        struct Level
+        {
+            float cellSize;         // Grid cell size (model units)
+            size_t numUpdateIts;    // Update iterations at this level
+        };  // end struct
+        std::vector<Level> levels;  // Empty
     };  // end struct
 
     static void setParams( const Params&);
+    static Params params();
 
     // Register the currently set mask against the given face model and return it.
     // The model must have first been brought into reasonable rigid alignment with the mask.
-    static r3d::Mesh::Ptr registerMask( const FM*);
+    // The first version uses the parameters given to setParams. If the cancel function
+    // returns true before registration completes, null is returned and nothing is cached.
+    // If align is given, it is set to calcMaskAlignment of the returned mask.
+    static r3d::Mesh::Ptr registerMask( const FM*, const CancelFn &cfn=nullptr, Mat4f *align=nullptr);
+    static r3d::Mesh::Ptr registerMask( const FM*, const Params&, const CancelFn &cfn=nullptr, Mat4f *align=nullptr);
+
+    // Registered mask vertices and their alignment are cached on disk keyed by the hash of the model's
+    // mesh (including its transform), the hash of the mask and the parameters so that registering the
+    // same mask to the same model again reads the result back rather than recomputing it. The directory
+    // defaults to "registrations" under the application's cache location. Set an empty path to disable.
+    static void setCacheDir( const QString&);
+    static QString cacheDir();
+
+    // The maximum total size in bytes of the cached registrations (256 MB by default). After each new
+    // entry is written, the least recently used entries are removed until the total is within the limit.
+    static void setCacheLimit( qint64);
+    static qint64 cacheLimit();
+
+    // Remove all cached registrations.
+    static void clearCache();
 
     // Given a deformed version of the loaded mask, run procrustes superimposition
     // on it and return its transform from the currently loaded mask.
     static Mat4f calcMaskAlignment( const r3d::Mesh&);
 
 private:
-    static MaskData s_mask;
-    static QReadWriteLock s_lock;
+    static MaskPtr s_mask;              // Only accessed through std::atomic_load/store
+    static QReadWriteLock s_cacheLock;  // Guards the cache directory
     static Params s_params;
+    static QString s_cacheDir;
+    static bool s_cacheDirSet;
+    static qint64 s_cacheLimit;
 };  // end class
 
 }   // end namespace
@@ -0,0 +1,81 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_METRIC_DEFINITION_CACHE_H
+#define FACE_TOOLS_METRIC_DEFINITION_CACHE_H
+
+/**
+ * Binary snapshot of definitions parsed from a directory of Lua files (metrics, growth
+ * statistics, HPO terms) so they can be restored on startup without executing the scripts.
+ * A snapshot is keyed by the hash of the names and contents of the files it was made from
+ * (plus any salt given, e.g. the key of a snapshot it depends on) and the format VERSION.
+ * If either differs the snapshot is ignored and the loader parses the files and writes a new
+ * snapshot. Snapshots are written atomically so concurrent processes can share a directory.
+ */
+
+#include <FaceTools/FaceTypes.h>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFile>
+
+namespace FaceTools { namespace Metric {
+
+class FaceTools_EXPORT DefinitionCache
+{
+public:
+    static const quint32 VERSION = 1;   // Increment whenever the content of any snapshot changes
+
+    // Snapshots are kept in "definitions" under the application's cache location
+    // unless set otherwise here. Set an empty path to disable snapshots.
+    static void setCacheDir( const QString&);
+    static QString cacheDir();
+
+    // Remove all snapshots.
+    static void clearCache();
+
+    // Returns the key of the snapshot with the given name as last checked (empty if disabled).
+    static QByteArray key( const QString &name);
+
+    // Check for the snapshot with the given name made from the given source files.
+    DefinitionCache( const QString &name, const QStringList &fpaths, const QByteArray &salt=QByteArray());
+
+    // Returns the stream to read the snapshot's data from if a valid snapshot exists (else null).
+    QDataStream* read();
+
+    // Returns the stream to write a new snapshot's data to (null if snapshots are disabled).
+    QDataStream* write();
+
+    // Commit the snapshot written returning true on success.
+    bool commit();
+
+private:
+    QString _fpath;
+    QByteArray _key;
+    QFile _rfile;
+    QSaveFile _wfile;
+    QDataStream _stream;
+    static QString s_cacheDir;
+    static bool s_cacheDirSet;
+    static std::unordered_map<QString, QByteArray> s_keys;
+
+    DefinitionCache( const DefinitionCache&) = delete;
+    void operator=( const DefinitionCache&) = delete;
+};  // end class
+
+}}   // end namespaces
+
+#endif
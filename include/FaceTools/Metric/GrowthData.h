@@ -19,7 +19,8 @@
 #define FACE_TOOLS_METRIC_GROWTH_DATA_H
 
 #include <FaceTools/FaceTypes.h>
-#include <rlib/RangedScalarDistribution.h>
+#include "GrowthTable.h"
+#include <QDataStream>
 
 namespace FaceTools { namespace Metric {
 
@@ -41,6 +42,10 @@ public:
     // Load growth data statistics from the given file.
     static bool load( const QString&);
 
+    // Write to and read from a definition snapshot (see DefinitionCache). Returns null on read error.
+    void write( QDataStream&) const;
+    static Ptr read( QDataStream&);
+
     int id() const { return _id;}
     void setId( int id) { _id = id;}
 
@@ -66,9 +71,19 @@ public:
     void setInPlane( bool v) { _inplane = v;}
     bool inPlane() const { return _inplane;}
 
-    void setRSD( size_t d, const rlib::RSD::Ptr& rsd) { _rsds[d] = rsd;}
+    // Setting the distribution for a dimension also (re)builds its lookup table.
+    void setRSD( size_t d, const rlib::RSD::Ptr&);
     rlib::RSD::CPtr rsd( size_t d=0) const { return _rsds.at(d);}
 
+    // The precomputed lookup table for dimension d used for z-scoring.
+    const GrowthTable& table( size_t d=0) const { return _tables.at(d);}
+
+    // Set zs[k] to the z-score of vals[k] at ages[k] on dimension d for k in [0,n).
+    void zscores( size_t d, size_t n, const float *ages, const float *vals, float *zs) const
+    {
+        _tables.at(d).zscores( n, ages, vals, zs);
+    }   // end zscores
+
     // Returns true iff the given age is >= min and <= max age domain across
     // all of the dimensions of the statistics.
     bool isWithinAgeRange( float age) const;
@@ -84,6 +99,7 @@ private:
     bool _inplane;
     QString _source, _note, _lnote;
     std::vector<rlib::RSD::Ptr> _rsds;
+    std::vector<GrowthTable> _tables;
 
     GrowthData( int mid, size_t ndims, int8_t sex, int ethn);
     GrowthData( const GrowthData&) = delete;
@@ -0,0 +1,85 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_METRIC_GROWTH_TABLE_H
+#define FACE_TOOLS_METRIC_GROWTH_TABLE_H
+
+/**
+ * Dense age indexed lookup table of the mean and standard deviation of a single dimension
+ * of a growth curve. The curve is sampled at STEPS_PER_YEAR evenly spaced ages over the age
+ * domain used for z-scoring (ages outside this domain are clamped to it as MetricValue always
+ * has done) and queries interpolate linearly between the two nearest samples. Means and
+ * standard deviations are held in separate contiguous arrays so batches of queries run as
+ * a tight branch free loop rather than a search over the curve's data points per query.
+ */
+
+#include <FaceTools/FaceTypes.h>
+#include <rlib/RangedScalarDistribution.h>
+
+namespace FaceTools { namespace Metric {
+
+class FaceTools_EXPORT GrowthTable
+{
+public:
+    static const int STEPS_PER_YEAR = 12;
+
+    GrowthTable();
+
+    // Sample the given distribution (which may be null to make an empty table).
+    explicit GrowthTable( const rlib::RSD*);
+
+    bool empty() const { return _mean.empty();}
+
+    // The age domain of the table.
+    float minAge() const { return _t0;}
+    float maxAge() const { return _t1;}
+
+    // Returns the mean and standard deviation at the given age (clamped to the table's age domain).
+    float mean( float age) const;
+    float sd( float age) const;
+
+    // Returns the z-score of value v at the given age.
+    float zscore( float age, float v) const;
+
+    // Set zs[k] to the z-score of vals[k] at ages[k] for k in [0,n).
+    void zscores( size_t n, const float *ages, const float *vals, float *zs) const;
+
+    // Set zs[k] to the z-score of vals[k] at the given age for k in [0,n).
+    void zscores( size_t n, float age, const float *vals, float *zs) const;
+
+    // Returns the largest absolute difference between the z-scores calculated from this table and
+    // from the given distribution for values two standard deviations above the distribution's mean
+    // at each of the table's sample ages and at the midpoints between them.
+    float maxError( const rlib::RSD&) const;
+
+private:
+    float _t0, _t1;     // Age domain
+    float _ipy;         // Samples per year (inverse of the sample spacing)
+    int _last;          // Index of the second last sample (interpolation base at the top of the domain)
+    std::vector<float> _mean, _sd;
+
+    inline void _index( float age, int &i, float &f) const
+    {
+        const float x = (std::max( _t0, std::min( age, _t1)) - _t0) * _ipy;
+        i = std::min( int(x), _last);
+        f = x - float(i);
+    }   // end _index
+};  // end class
+
+}}   // end namespaces
+
+#endif
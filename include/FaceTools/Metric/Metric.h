@@ -26,9 +26,24 @@
 #include "GrowthDataRanker.h"
 #include "MetricSet.h"
 #include <FaceTools/LndMrk/Landmark.h>
+#include <QDataStream>
 
 namespace FaceTools { namespace Metric {
 
+// The definition of a metric as given in its Lua file (landmarks are kept as their codes).
+struct FaceTools_EXPORT MetricDefinition
+{
+    int id;
+    QString name, desc, regn;
+    size_t ndps;
+    QString catg, norm, rmks;
+    bool blat;
+    std::vector< std::vector< std::vector<QString> > > pnts;  // Landmark codes per point per dimension
+};  // end struct
+
+FaceTools_EXPORT QDataStream& operator<<( QDataStream&, const MetricDefinition&);
+FaceTools_EXPORT QDataStream& operator>>( QDataStream&, MetricDefinition&);
+
 class FaceTools_EXPORT Metric
 {
 public:
@@ -41,6 +56,12 @@ public:
     // On error, return null.
     static Ptr load( const QString& filepath);
 
+    // Parse the definition from the given file returning false on error.
+    static bool parse( const QString& filepath, MetricDefinition&);
+
+    // Create from a parsed definition returning null on error.
+    static Ptr create( const MetricDefinition&);
+
     inline int id() const { return _mct->id();}
     inline const QString &name() const { return _name;}
     inline const QString &description() const { return _desc;}
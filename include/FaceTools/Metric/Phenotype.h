@@ -19,8 +19,10 @@
 #define FACE_TOOLS_METRIC_PHENOTYPE_H
 
 #include <FaceTools/FaceTypes.h>
-#include "MetricSet.h"
+#include "PhenotypeCriteria.h"
 #include <sol.hpp>
+#include <QDataStream>
+#include <QMutex>
 
 namespace FaceTools { namespace Metric {
 
@@ -35,6 +37,12 @@ public:
     // Create a new empty Phenotype object.
     static Ptr create();
 
+    // Write to and read from a definition snapshot (see DefinitionCache). Returns null on read
+    // error. Criteria that were compiled are recompiled when read so no Lua state is created for
+    // them unless useCompiled is false. Other criteria are loaded from the script when first needed.
+    void write( QDataStream&) const;
+    static Ptr read( QDataStream&);
+
     void setId( int id) { _id = id;}
     int id() const { return _id;}
 
@@ -89,10 +97,25 @@ public:
      * Check if this phenotypic indication is present given the measurements
      * recorded in the metric sets of the provided model and the assessment
      * data (landmarks). Uses the currently set assessment if assessId = -1.
-     * Ignores demographic data about the model.
+     * Ignores demographic data about the model. May be called concurrently;
+     * since Lua states are not re-entrant, each concurrent call evaluates the
+     * criteria in its own Lua state taken from a pool of states that grows
+     * as needed by reloading the script this phenotype was loaded from.
      */
     bool isPresent( const FM*, int assessId=-1) const;
 
+    // Returns the number of Lua states this phenotype has created to evaluate its criteria.
+    size_t numEvaluators() const;
+
+    // Returns true iff the criteria (the script's determine function) were compiled natively
+    // (see PhenotypeCriteria) in which case isPresent evaluates them without going through Lua.
+    bool isCompiled() const { return _criteria != nullptr;}
+
+    // Set/get whether natively compiled criteria are used (default true). Set false
+    // to evaluate all criteria with Lua (e.g. to benchmark or check compiled criteria).
+    static void setUseCompiled( bool v) { s_useCompiled = v;}
+    static bool useCompiled() { return s_useCompiled;}
+
     ~Phenotype(){}  // Public for Lua
 
 private:
@@ -105,8 +128,24 @@ private:
     QString _remarks;
     QStringList _refs;
     IntSet _metrics;
-    sol::state _lua;
-    sol::function _determine;
+    QString _fpath;     // Script loaded from
+
+    struct Evaluator
+    {
+        sol::state lua;
+        sol::function determine;
+    };  // end struct
+
+    bool _hasDetermine;
+    PhenotypeCriteria::Ptr _criteria;   // Null if the determine function couldn't be compiled
+    static bool s_useCompiled;
+    mutable QMutex _elock;
+    mutable std::vector<std::unique_ptr<Evaluator> > _idle;  // Evaluators not in use
+    mutable size_t _nevals;
+
+    static std::unique_ptr<Evaluator> _loadEvaluator( const QString&);
+    std::unique_ptr<Evaluator> _acquire() const;
+    void _release( std::unique_ptr<Evaluator>) const;
 
     /**
      * Returns true iff the given model has measurements for all of the
@@ -0,0 +1,111 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_METRIC_PHENOTYPE_CRITERIA_H
+#define FACE_TOOLS_METRIC_PHENOTYPE_CRITERIA_H
+
+/**
+ * Native compilation of the criteria of a phenotypic indication (the 'determine' function in
+ * a HPO term's Lua script) to a small stack based program so presence can be evaluated without
+ * going through Lua. Only functions of the form:
+ *
+ *   function( age, mset, lset, rset)
+ *       local x = <expr>   -- zero or more
+ *       return <expr>
+ *   end
+ *
+ * are compiled, where expressions are boolean combinations (and, or, not) of comparisons
+ * (<, <=, >, >=, ==, ~=) of arithmetic (+, -, *, /, unary minus and parentheses) on numbers,
+ * the age parameter, locals, and the measurements of metrics given by <set>:metric(<id>)
+ * followed by :zscore(age[,i]), :mean(age[,i]), :value([i]) or :ndims() (the metric may also
+ * be assigned to a local first). The parameter names are taken from the function's signature.
+ * Since Lua treats every number as true, boolean and numeric expressions are not allowed to mix
+ * and 'and'/'or' short circuit, so evaluation always gives the same result as the Lua function.
+ * Any function that can't be compiled (e.g. one having conditionals) must be evaluated by Lua.
+ */
+
+#include "MetricSet.h"
+
+namespace FaceTools { namespace Metric {
+
+class FaceTools_EXPORT PhenotypeCriteria
+{
+public:
+    using Ptr = std::shared_ptr<PhenotypeCriteria>;
+
+    // Compile the given source of the function returning null if it can't be compiled,
+    // in which case the reason is set in err (if given).
+    static Ptr compile( const std::string &src, std::string *err=nullptr);
+
+    // Evaluate the criteria with the given age and mid, left and right metric sets. Returns
+    // false if a metric referenced by the criteria is missing from its set or doesn't have
+    // the dimension referenced (for which the Lua function would raise an error).
+    bool evaluate( float age, const MetricSet&, const MetricSet&, const MetricSet&) const;
+
+    // The IDs of the metrics referenced.
+    const IntSet& metrics() const { return _mids;}
+
+    // The number of instructions in the compiled program.
+    size_t size() const { return _code.size();}
+
+    // The source the program was compiled from.
+    const std::string& source() const { return _src;}
+
+    static const int MAX_STACK = 32;
+    static const int MAX_LOCALS = 32;
+
+private:
+    enum Op : uint8_t
+    {
+        CONST,  // Push val
+        AGE,    // Push the age
+        LOAD,   // Push local[id]
+        STORE,  // Pop to local[id]
+        ZSCORE, // Pop age, push z-score of metric id in set at dimension dim
+        MEAN,   // Pop age, push mean of metric id in set at dimension dim
+        VALUE,  // Push value of metric id in set at dimension dim
+        NDIMS,  // Push number of dimensions of metric id in set
+        ADD, SUB, MUL, DIV, NEG,
+        LT, LE, GT, GE, EQ, NE, NOT,
+        JF,     // Jump to id if top is false (without popping)
+        JT,     // Jump to id if top is true (without popping)
+        POP
+    };  // end enum
+
+    struct Instr
+    {
+        Op op;
+        int set;    // Metric set (0=mid, 1=left, 2=right)
+        int id;     // Metric ID, local index or jump target
+        int dim;    // Metric dimension
+        double val; // Constant value
+    };  // end struct
+
+    std::vector<Instr> _code;
+    IntSet _mids;
+    int _nlocals;
+    std::string _src;
+
+    PhenotypeCriteria() : _nlocals(0) {}
+    PhenotypeCriteria( const PhenotypeCriteria&) = delete;
+    void operator=( const PhenotypeCriteria&) = delete;
+    friend class CriteriaCompiler;
+};  // end class
+
+}}   // end namespaces
+
+#endif
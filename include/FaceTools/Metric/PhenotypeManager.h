@@ -65,9 +65,17 @@ public:
     // assessment ID. If the assessment ID is < 0, then the current assessment set on the
     // model is used. Demographic information about the model is ignored here - the only
     // consideration is if the model has the necessary measurements of the metrics
-    // corresponding to each phenotypic indication.
+    // corresponding to each phenotypic indication. Terms are evaluated in parallel and
+    // concurrent calls are allowed since each phenotype evaluates its criteria using its
+    // own pool of Lua states (one per concurrent evaluation).
     static IntSet discover( const FM*, int aid=-1);
 
+    // Discover the PhenotypicIndication IDs for each of the given models (returned in the
+    // same order) as above. All model and term pairs are evaluated in parallel so screening
+    // a whole cohort of models scales with the number of cores (see setParallelChunksThreads
+    // for limiting this when called from worker threads).
+    static std::vector<IntSet> discover( const std::vector<const FM*>&, int aid=-1);
+
 private:
     static IntSet _ids;
     static QStringList _names;                             // Phenotype names
@@ -75,6 +83,7 @@ private:
     static std::unordered_map<int, Phenotype::Ptr> _hpos;  // Phenotype terms keyed by their IDs
     static std::unordered_map<int, IntSet> _mhpos;         // IDs of terms keyed by metric ID
     static std::unordered_map<QString, IntSet> _rhpos;     // IDs of terms keyed by region string
+    static std::vector<Phenotype::Ptr> _hvec;              // Phenotype terms as a list (for parallel discovery)
 };  // end class
 
 }}  // end namespaces
@@ -22,6 +22,7 @@
 #include <r3d/Mesh.h>   // r3d
 #include <QTemporaryFile>
 #include <vtkIdList.h>
+#include <functional>
 
 namespace FaceTools {
 
@@ -119,6 +120,23 @@ FaceTools_EXPORT int toVector( const vtkSmartPointer<vtkIdList>&, std::vector<in
 
 // Return contents of stream as a front/rear trimmed QString optionally in lowercase.
 FaceTools_EXPORT QString getRmLine( std::istringstream&, bool lower=false);
+
+// Split the index range [0,n) into contiguous chunks of at least minChunk indices and call
+// fn(i0,i1) for each chunk [i0,i1) with chunks processed in parallel over up to
+// QThread::idealThreadCount threads (the calling thread included) or the number set for the
+// calling thread with setParallelChunksThreads. Blocks until done. Chunks never overlap so fn may
+// write to disjoint ranges of a shared output buffer. Nested calls from within fn run serially.
+FaceTools_EXPORT void parallelChunks( size_t n, const std::function<void( size_t, size_t)> &fn, size_t minChunk=1024);
+
+// Set the maximum number of threads parallelChunks may use when called from the calling thread
+// (zero to reset to QThread::idealThreadCount). Threads in a pool of workers should set their
+// share of the cores so that nested parallel work doesn't oversubscribe them.
+FaceTools_EXPORT void setParallelChunksThreads( size_t);
+
+// Sub-sample the vertices of the given mesh (which must have sequential vertex IDs) by keeping the
+// first vertex in each occupied cell of a regular grid with the given cell size. Transformed vertex
+// positions are used. Returns the IDs of the kept vertices in ascending order.
+FaceTools_EXPORT std::vector<int> subsampleVertices( const r3d::Mesh&, float cellSize);
 }   // end namespace
 
 #endif
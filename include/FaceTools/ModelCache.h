@@ -0,0 +1,140 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_MODEL_CACHE_H
+#define FACE_TOOLS_MODEL_CACHE_H
+
+/**
+ * Cache of per model data where each model's entry has its own read/write lock.
+ * The registry lock is only held while looking up, adding or removing entries
+ * so threads working on different models never wait on one another.
+ * Lock acquisitions that had to wait are counted for diagnosing contention.
+ */
+
+#include "FaceTypes.h"
+#include <QReadWriteLock>
+#include <atomic>
+
+namespace FaceTools {
+
+template <typename T>
+class ModelCache
+{
+public:
+    using RPtr = std::shared_ptr<const T>;
+    using WPtr = std::shared_ptr<T>;
+
+    ModelCache() : _contention(0) {}
+
+    // Return the data for the given model or null if not present.
+    // The model entry's read lock is held while the returned shared ptr is alive.
+    RPtr read( const FM *fm) const
+    {
+        std::shared_ptr<Entry> e = _entry( fm);
+        if ( !e)
+            return nullptr;
+        if ( !e->lock.tryLockForRead())
+        {
+            ++_contention;
+            e->lock.lockForRead();
+        }   // end if
+        return RPtr( e->data.get(), [e]( const T*){ e->lock.unlock();});
+    }   // end read
+
+    // Return the data for the given model or null if not present.
+    // The model entry's write lock is held while the returned shared ptr is alive.
+    WPtr write( const FM *fm)
+    {
+        std::shared_ptr<Entry> e = _entry( fm);
+        if ( !e)
+            return nullptr;
+        if ( !e->lock.tryLockForWrite())
+        {
+            ++_contention;
+            e->lock.lockForWrite();
+        }   // end if
+        return WPtr( e->data.get(), [e]( T*){ e->lock.unlock();});
+    }   // end write
+
+    // Set (or replace) the data for the given model. Clients still holding
+    // the previous data keep it alive until they release it.
+    void set( const FM *fm, const std::shared_ptr<T> &data)
+    {
+        std::shared_ptr<Entry> e( new Entry);
+        e->data = data;
+        _lockRegistryForWrite();
+        _entries[fm] = e;
+        _rlock.unlock();
+    }   // end set
+
+    // Remove the data for the given model.
+    void purge( const FM *fm)
+    {
+        _lockRegistryForWrite();
+        _entries.erase( fm);
+        _rlock.unlock();
+    }   // end purge
+
+    // Returns true iff data for the given model is present.
+    bool has( const FM *fm) const { return _entry( fm) != nullptr;}
+
+    // Returns the number of lock acquisitions (registry or per model) that had to wait.
+    size_t contention() const { return _contention;}
+    void resetContention() { _contention = 0;}
+
+private:
+    struct Entry
+    {
+        QReadWriteLock lock;
+        std::shared_ptr<T> data;
+    };  // end struct
+
+    std::unordered_map<const FM*, std::shared_ptr<Entry> > _entries;
+    mutable QReadWriteLock _rlock;
+    mutable std::atomic<size_t> _contention;
+
+    std::shared_ptr<Entry> _entry( const FM *fm) const
+    {
+        if ( !_rlock.tryLockForRead())
+        {
+            ++_contention;
+            _rlock.lockForRead();
+        }   // end if
+        std::shared_ptr<Entry> e;
+        const auto it = _entries.find( fm);
+        if ( it != _entries.end())
+            e = it->second;
+        _rlock.unlock();
+        return e;
+    }   // end _entry
+
+    void _lockRegistryForWrite()
+    {
+        if ( !_rlock.tryLockForWrite())
+        {
+            ++_contention;
+            _rlock.lockForWrite();
+        }   // end if
+    }   // end _lockRegistryForWrite
+
+    ModelCache( const ModelCache&) = delete;
+    void operator=( const ModelCache&) = delete;
+};  // end class
+
+}   // end namespace
+
+#endif
@@ -60,8 +60,22 @@ public:
     // only Meshes with a single material are accepted (for models having multiple materials, use
     // Mesh::mergeMaterials beforehand). If the Mesh doesn't have any materials, a warning will
     // be printed to stderr and only non-texture mapped visualisations will be available.
+    // All views of the same model share a single polydata (points, faces, normals, texture coordinates
+    // and mapped arrays) and texture, with each view having its own actor and mapper for its own
+    // properties and scalar mapping. If another view of the model already has polydata generated from
+    // the model's current mesh, this view's new actor uses those; otherwise the polydata are regenerated
+    // and the model's other views are switched over to them.
     void reset();
 
+    // Update the existing actor in place from the data model rather than regenerating it. Vertex positions
+    // are rewritten into the actor's points and the faces are rewritten only if they changed (e.g. appended
+    // or removed). Normals are then reset and the applied visualisations reapplied to remap their arrays.
+    // Since the polydata are shared, only the first view of a model to be updated after its mesh changes
+    // rewrites them; the model's other views just reapply their visualisations.
+    // Falls back to reset if the model doesn't have sequential IDs, or if its faces changed and the actor
+    // is texture mapped (since texture coordinates are only generated with the actor).
+    void update();
+
     // Reset just the normals from generated FaceModelCurvature.
     void resetNormals();
 
@@ -153,6 +167,7 @@ private:
     vtkSmartPointer<vtkActor> _actor;       // The face actor.
     vtkSmartPointer<vtkTexture> _texture;   // The texture map (if generated).
     vtkSmartPointer<vtkFloatArray> _nrms;   // Surface normals.
+    std::weak_ptr<const r3d::Mesh> _mesh;   // The mesh the (shared) polydata were last made from.
     FMV *_viewer;                           // The viewer this view is attached to.
     FMV *_pviewer;                          // The previous viewer this view was attached to.
     ScalarVisualisation *_smm;              // The active surface scalar mapping (if not null).
@@ -165,6 +180,10 @@ private:
     static bool s_interpolateShading;
 
     void _setVisible( BaseVisualisation*, bool);
+    void _reapplyVisualisations();
+    bool _isCurrent() const;
+    const FaceView* _sharedView() const;
+    void _shareWithViews();
     void _updateSurfaceProperties();
     FaceView( const FaceView&) = delete;
     FaceView& operator=( const FaceView&) = delete;
@@ -63,8 +63,13 @@ public:
     bool isVisible( const FV* fv) const override { return static_cast<const Derived*>(this)->isVisible( fv);}
 
     // Allow this class to decide if it's appropriate to purge data for the given event and face view.
+    // Since the polydata are shared by all views of the model, the mapped array is only removed
+    // if this visualisation isn't also applied to any of the model's other views.
     void purge( const FV* fv) override
     {
+        for ( const FV *ofv : fv->data()->fvs())
+            if ( ofv != fv && ofv->isApplied(this))
+                return;
         const std::string lab = _label.toStdString();
         if ( _mapsPolys)
             r3dvis::getPolyData( fv->actor())->GetCellData()->RemoveArray(lab.c_str());
@@ -0,0 +1,54 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FACE_TOOLS_VISCO_ELASTIC_REGISTRATION_H
+#define FACE_TOOLS_VISCO_ELASTIC_REGISTRATION_H
+
+/**
+ * Multi-threaded non-rigid registration of a floating mesh (the mask) to a target surface.
+ * Each update iteration finds push (floating to the weighted mean of its k closest target points)
+ * and pull (target to closest floating) point correspondences in parallel, estimates robust inlier weights for them, and regularises
+ * the resulting force field with a visco-elastic model. Every smoothing pass is a per vertex
+ * Gaussian weighted average over that vertex's nearest neighbours on the floating mesh and is
+ * done in parallel. The number of smoothing passes anneals from stiff to flexible over the
+ * update iterations. Uses the same parameters as rNonRigid::NonRigidRegistration.
+ */
+
+#include "MaskRegistration.h"
+#include <r3d/KDTree.h>
+
+namespace FaceTools {
+
+class FaceTools_EXPORT ViscoElasticRegistration
+{
+public:
+    explicit ViscoElasticRegistration( const MaskRegistration::Params&);
+
+    // Register floating to the target mesh returning the registered (transformed) positions of
+    // the floating mesh's vertices as rows indexed by vertex ID. Both meshes must have sequential
+    // vertex IDs and the KD-tree must be of the target (as given by FaceModel::kdtree).
+    // The cancel function is checked every update iteration; if cancelled, no rows are returned.
+    MatX3f operator()( const r3d::Mesh &floating, const r3d::Mesh &target, const r3d::KDTree &tkdt,
+                       const CancelFn &cfn=nullptr) const;
+
+private:
+    const MaskRegistration::Params _prms;
+};  // end class
+
+}   // end namespace
+
+#endif
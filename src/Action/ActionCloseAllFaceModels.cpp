@@ -39,7 +39,7 @@ bool ActionCloseAllFaceModels::isAllowed( Event) { return FMM::numOpen() > 0;}
 bool ActionCloseAllFaceModels::doBeforeAction( Event)
 {
     bool doshowmsg = false;
-    const FMS& models = FMM::opened();
+    const FMS models = FMM::opened();
     for ( FM* fm : models)
     {
         fm->lockForRead();
@@ -64,9 +64,9 @@ bool ActionCloseAllFaceModels::doBeforeAction( Event)
 void ActionCloseAllFaceModels::doAction( Event)
 {
     UndoStates::clear();
-    const FMS& models = FMM::opened();
-    while ( !models.empty())
-        FAM::close( *models.begin());
+    const FMS models = FMM::opened();
+    for ( FM* fm : models)
+        FAM::close( fm);
 }   // end doAction
 
 
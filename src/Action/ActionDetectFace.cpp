@@ -37,7 +37,7 @@ using MS = FaceTools::Action::ModelSelector;
 
 
 ActionDetectFace::ActionDetectFace( const QString& dn, const QIcon& icon)
-    : FaceAction(dn, icon), _cdialog(nullptr), _ev(Event::NONE)
+    : FaceAction(dn, icon), _cdialog(nullptr), _ev(Event::NONE), _cancelled(false)
 {
     setAsync( true);
 }   // end ctor
@@ -89,19 +89,25 @@ void ActionDetectFace::doAction( Event)
 {
     FM *fm = MS::selectedModel();
     fm->lockForWrite();
-    detect( fm, _ulmks);
+    _cancelled = !detect( fm, _ulmks, cancelFn());
     fm->unlock();
 }   // end doAction
 
 
 // public static
-void ActionDetectFace::detect( FM* fm, const IntSet &ulmks)
+bool ActionDetectFace::detect( FM* fm, const IntSet &ulmks, const CancelFn &cfn, bool doAlign)
 {
-    //std::cout << "Doing initial alignment of model..." << std::endl;
-    ActionAlignModel::align( fm);
-    fm->fixTransformMatrix();
+    if ( doAlign)
+    {
+        //std::cout << "Doing initial alignment of model..." << std::endl;
+        ActionAlignModel::align( fm);
+        fm->fixTransformMatrix();
+    }   // end if
     //std::cout << "Registering mask against target face..." << std::endl;
-    r3d::Mesh::Ptr mask = MaskRegistration::registerMask( fm);
+    Mat4f align;
+    r3d::Mesh::Ptr mask = MaskRegistration::registerMask( fm, cfn, &align);
+    if ( !mask)
+        return false;
 
     //std::cout << "Setting mask..." << std::endl;
     fm->setMask( mask);
@@ -113,17 +119,23 @@ void ActionDetectFace::detect( FM* fm, const IntSet &ulmks)
         ActionRestoreLandmarks::restoreLandmarks( fm, ulmks, false);
     }   // end if
 
-    //std::cout << "Doing Procrustes alignment of the coregistered mask with the original..." << std::endl;
-    const Mat4f align = MaskRegistration::calcMaskAlignment( *mask);
+    // Procrustes alignment of the coregistered mask with the original (calculated during registration).
     const Mat4f ialign = align.inverse();
 
     fm->addTransformMatrix( ialign);
     fm->fixTransformMatrix();
+    return true;
 }   // end detect
 
 
 Event ActionDetectFace::doAfterAction( Event)
 {
+    if ( _cancelled)    // Roll back the alignment
+    {
+        MS::showStatus( "Face detection cancelled.", 5000);
+        return rollbackLastUndo( workingModel());
+    }   // end if
+
     ActionOrientCameraToFace::orientToFace( MS::selectedView(), 1);
     MS::clearStatus();
     MS::setInteractionMode( IMode::CAMERA_INTERACTION);
@@ -28,7 +28,7 @@ using MS = FaceTools::Action::ModelSelector;
 
 
 ActionFillHoles::ActionFillHoles( const QString& dn, const QIcon& ico)
-    : FaceAction(dn, ico)
+    : FaceAction(dn, ico), _cancelled(false)
 {
     setAsync(true);
     addRefreshEvent( Event::MESH_CHANGE);
@@ -95,8 +95,11 @@ void ActionFillHoles::doAction( Event)
     const size_t nm = manfs->count();
     Mesh::Ptr mesh = fm->mesh().deepCopy();
     Manifolds::Ptr nmanfs;
+    const CancelFn cfn = cancelFn();
+    _cancelled = false;
 
-    while ( true)
+    // Holes are filled on a copy of the mesh which is discarded if cancelled.
+    while ( !_cancelled)
     {
         HoleFiller hfiller( mesh);
         std::vector<int> mholes(nm);    // Record the number of holes per manifold
@@ -115,6 +118,9 @@ void ActionFillHoles::doAction( Event)
             int polysAdded = 0;
             for ( int j = 1; j < nbs; ++j)  // Ignore the first (longest) boundary
             {
+                _cancelled = CancelToken::isCancelled( cfn);
+                if ( _cancelled)
+                    break;
                 const std::list<int>& blist = bnds.boundary(j);
                 polysAdded += hfiller.fillHole( blist, mpolys);
             }   // end for
@@ -128,8 +134,8 @@ void ActionFillHoles::doAction( Event)
             sumPolysAdded += polysAdded;
         }   // end for
 
-        // If no polygons added, break loop.
-        if ( sumPolysAdded == 0)
+        // If no polygons added (or cancelled), break loop.
+        if ( sumPolysAdded == 0 || _cancelled)
             break;
 
         nmanfs = Manifolds::create( *mesh);
@@ -138,14 +144,21 @@ void ActionFillHoles::doAction( Event)
         manfs = nmanfs.get();
     }   // end while
 
-    fm->update( mesh, true, true);
+    if ( !_cancelled)
+        fm->update( mesh, true, true);
     fm->unlock();
 }   // end doAction
 
 
 Event ActionFillHoles::doAfterAction( Event)
 {
-    const FM* fm = MS::selectedModel();
+    const FM* fm = workingModel();
+    if ( _cancelled)
+    {
+        scrapLastUndo( fm);
+        MS::showStatus( "Hole filling cancelled.", 5000);
+        return Event::CANCEL;
+    }   // end if
 
     const size_t nh = getNumHoles( fm->manifolds());
     MS::showStatus( QString("Finished hole filling; %1 hole%2 remain%3.").arg(nh == 0 ? "no" : QString("%1").arg(nh)).arg( nh != 1 ? "s" : "").arg( nh == 1 ? "s" : ""), 5000);
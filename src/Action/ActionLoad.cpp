@@ -18,6 +18,7 @@
 #include <Action/ActionLoad.h>
 #include <Action/ActionOrientCameraToFace.h>
 #include <FileIO/FaceModelManager.h>
+#include <FaceModel.h>
 #include <QFileInfo>
 using FaceTools::Action::ActionLoad;
 using FaceTools::Action::Event;
@@ -30,9 +31,12 @@ using MS = FaceTools::Action::ModelSelector;
 
 
 ActionLoad::ActionLoad( const QString& dn, const QIcon& ico, const QKeySequence& ks)
-    : FaceAction( dn, ico, ks), _loadHelper(nullptr), _dialog(nullptr)
+    : FaceAction( dn, ico, ks), _loadHelper(nullptr), _dialog(nullptr), _lastFV(nullptr)
 {
     setAsync(true);
+    // Models are shown as soon as each is ready rather than after all have loaded.
+    qRegisterMetaType<FaceTools::FM*>();
+    connect( this, &ActionLoad::_onLoadedModel, this, &ActionLoad::_doOnLoadedModel, Qt::QueuedConnection);
 }   // end ctor
 
 
@@ -77,6 +81,7 @@ bool ActionLoad::doBeforeAction( Event)
     if ( _loadHelper->filenames().empty() && _dialog->exec())
         _loadHelper->setFilteredFilenames( _dialog->selectedFiles());
 
+    _lastFV = nullptr;
     const bool doLoad = _loadHelper->filenames().size() > 0;
     if ( doLoad)
     {
@@ -93,18 +98,24 @@ bool ActionLoad::doBeforeAction( Event)
 
 void ActionLoad::doAction( Event)
 {
-    _loadHelper->loadModels();
+    _loadHelper->loadModels( [this]( FM* fm){ emit _onLoadedModel( fm);});
 }   // end doAction
 
 
+// Queued to the GUI thread as each model finishes loading (and so before doAfterAction).
+void ActionLoad::_doOnLoadedModel( FM* fm)
+{
+    _lastFV = MS::add( fm, MS::defaultViewer());
+    MS::showStatus( QString("Loaded %1").arg(FMM::filepath(fm)));
+}   // end _doOnLoadedModel
+
+
 Event ActionLoad::doAfterAction( Event)
 {
     MS::defaultViewer()->resetDefaultCamera();
     _loadHelper->showLoadErrors();
-    const FMS& fms = _loadHelper->lastLoaded();
-    FV *fv = nullptr;
-    for ( FM* fm : fms)
-        fv = MS::add( fm, MS::defaultViewer());
+    FV *fv = _lastFV;
+    _lastFV = nullptr;
 
     Event e;
     if ( fv)
@@ -157,25 +157,20 @@ void ActionMakeHalfFace::doAction( Event)
         r3d::Mesh::Ptr mask = fm->mask().deepCopy();
         mask->fixTransformMatrix();
 
-        const auto &maskData = MaskRegistration::maskData();
-        const auto &oppVtxs = maskData->oppVtxs;
-        const IntSet &l0 = maskData->q0;  // Top left
-        const IntSet &l1 = maskData->q3;  // Bottom left
+        const MaskRegistration::MaskPtr mdata = MaskRegistration::maskData();
+        const std::vector<int> &opp = mdata->opposite;
+        const int nv = int(opp.size());
 
-        if ( _n[0] < 0)
+        // Left side vertices are those in the top left (Q0) or bottom left (Q3) quadrants
+        for ( int lvidx = 0; lvidx < nv; ++lvidx)
         {
-            for ( int lvidx : l0)
-                mask->adjustRawVertex( lvidx, mask->uvtx( oppVtxs.at( lvidx)));
-            for ( int lvidx : l1)
-                mask->adjustRawVertex( lvidx, mask->uvtx( oppVtxs.at( lvidx)));
-        }   // end if
-        else
-        {
-            for ( int lvidx : l0)
-                mask->adjustRawVertex( oppVtxs.at(lvidx), mask->uvtx( lvidx));
-            for ( int lvidx : l1)
-                mask->adjustRawVertex( oppVtxs.at(lvidx), mask->uvtx( lvidx));
-        }   // end else
+            if ( !mdata->inQuadrant( lvidx, 0) && !mdata->inQuadrant( lvidx, 3))
+                continue;
+            if ( _n[0] < 0)
+                mask->adjustRawVertex( lvidx, mask->uvtx( opp[lvidx]));
+            else
+                mask->adjustRawVertex( opp[lvidx], mask->uvtx( lvidx));
+        }   // end for
 
         fm->setMask( mask);
     }   // end if
@@ -30,9 +30,12 @@ using FMC = FaceTools::FaceModelCurvature;
 
 ActionMapCurvature::ActionMapCurvature() : FaceAction( "Map Curvature")
 {
-    addPurgeEvent( Event::MESH_CHANGE);
     addTriggerEvent( Event::MESH_CHANGE);
     setAsync(true);
+    setReentrant(true);
+    // Progress is emitted from the worker thread so is queued to the GUI thread
+    connect( this, &ActionMapCurvature::onProgress, this, []( float p)
+            { MS::showStatus( QString("Mapping curvature... %1%").arg( int(100*p)));});
 }   // end ctor
 
 
@@ -41,17 +44,19 @@ bool ActionMapCurvature::isAllowed( Event) { return MS::selectedModel();}
 
 void ActionMapCurvature::doAction( Event e)
 {
-    const FM* fm = MS::selectedModel();
+    const FM* fm = workingModel();
     fm->lockForRead();
-    FMC::purge(fm);
-    FMC::add(fm);
+    // Only the changed region of the mesh is recomputed if curvature was mapped for a previous version.
+    // Cancelled if FaceActionWorker requests interruption (leaving the previous curvature data stale).
+    FMC::update( fm, [this]( float p){ emit onProgress(p);}, cancelFn());
     fm->unlock();
 }   // end doAction
 
 
 Event ActionMapCurvature::doAfterAction( Event)
 {
-    const FM *fm = MS::selectedModel();
+    MS::clearStatus();
+    const FM *fm = workingModel();
     for ( FV *fv : fm->fvs())
         fv->resetNormals();
     return Event::SURFACE_DATA_CHANGE;
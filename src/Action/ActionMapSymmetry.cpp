@@ -32,6 +32,7 @@ ActionMapSymmetry::ActionMapSymmetry() : FaceAction( "Map Symmetry")
     addPurgeEvent( Event::MESH_CHANGE | Event::MASK_CHANGE);
     addTriggerEvent( Event::MESH_CHANGE | Event::MASK_CHANGE);
     setAsync(true);
+    setReentrant(true);
 }   // end ctor
 
 
@@ -44,7 +45,7 @@ bool ActionMapSymmetry::isAllowed( Event)
 
 void ActionMapSymmetry::doAction( Event)
 {
-    const FM* fm = MS::selectedModel();
+    const FM* fm = workingModel();
     fm->lockForRead();
     FaceModelSymmetry::purge( fm);
     FaceModelSymmetry::add( fm);
@@ -38,7 +38,8 @@ bool ActionRedo::isAllowed( Event)
     if ( cando)
     {
         dname = QString("%1 '%2'").arg(_dname).arg( UndoStates::redoActionName());
-        ttip = dname;
+        const double mbytes = double( UndoStates::memoryUsage( MS::selectedModel())) / (1 << 20);
+        ttip = QString("%1 (undo history uses %2 MB)").arg(dname).arg( mbytes, 0, 'f', 1);
     }   // end if
     setDisplayName( dname);
     setToolTip( ttip);
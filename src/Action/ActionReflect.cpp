@@ -45,14 +45,16 @@ bool ActionReflect::isAllowed( Event) { return MS::isViewSelected();}
 
 void ActionReflect::saveState( UndoState &us) const
 {
-    us.setUserData( "Mesh", QVariant::fromValue( us.model()->mesh().deepCopy()));
+    us.setMesh( "Mesh", std::const_pointer_cast<r3d::Mesh>( us.model()->meshPtr()));   // Shared not copied
     us.setUserData( "Ass", QVariant::fromValue( us.model()->currentAssessment()->deepCopy()));
 }   // end saveState
 
 
 void ActionReflect::restoreState( const UndoState &us)
 {
-    us.model()->update( us.userData("Mesh").value<r3d::Mesh::Ptr>(), false, false);
+    r3d::Mesh::Ptr mesh = us.mesh("Mesh");
+    if ( mesh != us.model()->meshPtr())
+        us.model()->update( mesh, false, false);
     us.model()->setAssessment( us.userData("Ass").value<FaceAssessment::Ptr>());
 }   // end restoreState
 
@@ -73,20 +75,21 @@ bool ActionReflect::doBeforeAction( Event)
 namespace {
 void swapMaskLaterals( r3d::Mesh &mask)
 {
-    IntSet rset;
-    const auto &oppVtxs = FaceTools::MaskRegistration::maskData()->oppVtxs;
-    for ( const std::pair<int,int> &vpair : oppVtxs)
+    const FaceTools::MaskRegistration::MaskPtr mdata = FaceTools::MaskRegistration::maskData();
+    const std::vector<int> &opp = mdata->opposite;
+    const int nv = int(opp.size());
+    std::vector<bool> swapped( nv, false);
+    for ( int lvidx = 0; lvidx < nv; ++lvidx)
     {
-        const int lvidx = vpair.first;
-        const int rvidx = vpair.second;
-        assert( lvidx >= 0 && rvidx >= 0);
-        if ( rset.count(lvidx) == 0)
+        const int rvidx = opp[lvidx];
+        assert( rvidx >= 0);
+        if ( !swapped[lvidx])
         {
-            assert( rset.count( rvidx) == 0);
+            assert( !swapped[rvidx]);
             mask.swapVertexPositions( lvidx, rvidx);
         }   // end if
-        rset.insert(lvidx);
-        rset.insert(rvidx);
+        swapped[lvidx] = true;
+        swapped[rvidx] = true;
     }   // end for
 }   // end swapMaskLaterals
 }   // end namespace
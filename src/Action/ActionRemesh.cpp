@@ -53,8 +53,12 @@ void ActionRemesh::doAction( Event)
     r3d::VertexAdder vadder( model);
     vadder.subdivideAndMerge( maxTriangleArea());
     //vadder.addVerticesToMaxTriangleArea( maxTriangleArea());
-    fm->update(model);
-    fm->moveLandmarksToSurface();
+    // The vertex adder can't be interrupted but the remeshed copy is discarded if cancelled meanwhile.
+    if ( !CancelToken::isCancelled( cancelFn()))
+    {
+        fm->update(model);
+        fm->moveLandmarksToSurface();
+    }   // end if
     fm->unlock();
 }   // end doAction
 
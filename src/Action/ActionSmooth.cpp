@@ -21,6 +21,7 @@
 #include <FaceModel.h>
 #include <QMessageBox>
 #include <r3d/Smoother.h>
+#include <r3d/Curvature.h>
 using FaceTools::Action::FaceAction;
 using FaceTools::Action::ActionSmooth;
 using FaceTools::Action::Event;
@@ -35,7 +36,7 @@ void ActionSmooth::setMaxCurvature( double c) { s_maxc = std::max( 0.0, std::min
 void ActionSmooth::setMaxIterations( size_t i) { s_maxi = i;}
 
 
-ActionSmooth::ActionSmooth( const QString& dn, const QIcon& ico) : FaceAction(dn, ico)
+ActionSmooth::ActionSmooth( const QString& dn, const QIcon& ico) : FaceAction(dn, ico), _cancelled(false)
 {
     setAsync(true);
     addRefreshEvent( Event::SURFACE_DATA_CHANGE);
@@ -50,14 +51,16 @@ bool ActionSmooth::isAllowed( Event)
 
 void ActionSmooth::saveState( UndoState &us) const
 {
-    us.setUserData( "Mesh", QVariant::fromValue( us.model()->mesh().deepCopy()));
+    us.setMesh( "Mesh", std::const_pointer_cast<r3d::Mesh>( us.model()->meshPtr()));   // Shared not copied
     us.setUserData( "Ass", QVariant::fromValue( us.model()->currentAssessment()->deepCopy()));
 }   // end saveState
 
 
 void ActionSmooth::restoreState( const UndoState &us)
 {
-    us.model()->update( us.userData("Mesh").value<r3d::Mesh::Ptr>(), false, false);
+    r3d::Mesh::Ptr mesh = us.mesh("Mesh");
+    if ( mesh != us.model()->meshPtr())
+        us.model()->update( mesh, false, false);
     us.model()->setAssessment( us.userData("Ass").value<FaceAssessment::Ptr>());
 }   // end restoreState
 
@@ -89,18 +92,37 @@ void ActionSmooth::doAction( Event)
     FM* fm = MS::selectedModel();
     fm->lockForWrite();
     r3d::Mesh::Ptr mesh = fm->mesh().deepCopy();
-    FaceModelCurvature::WPtr cmap = FaceModelCurvature::wmetrics( fm);
 
-    // Updates curvature data for the mesh but should be reconstructed anyway.
-    r3d::Smoother( maxCurvature(), maxIterations())( *mesh, *cmap);
+    // r3d::Smoother needs an r3d::Curvature which it updates in place as it moves vertices, so it
+    // can't be given the model's cached CurvatureMap (a different type that is also shared with
+    // readers and must not be modified). The r3d::Curvature is therefore built here for the working
+    // copy and discarded after; the cached map is updated incrementally for the smoothed mesh in
+    // response to the mesh change. Smoothing is done one iteration at a time so it can be stopped
+    // between iterations in which case the working copy of the mesh is discarded.
+    r3d::Curvature::Ptr cmap = r3d::Curvature::create( *mesh);
+    const CancelFn cfn = cancelFn();
+    _cancelled = false;
+    for ( size_t i = 0; i < maxIterations() && !_cancelled; ++i)
+    {
+        _cancelled = CancelToken::isCancelled( cfn);
+        if ( !_cancelled)
+            r3d::Smoother( maxCurvature(), 1)( *mesh, *cmap);
+    }   // end for
 
-    fm->update( mesh, false, true);
+    if ( !_cancelled)
+        fm->update( mesh, false, true);
     fm->unlock();
 }   // end doAction
 
 
 Event ActionSmooth::doAfterAction( Event)
 {
+    if ( _cancelled)
+    {
+        scrapLastUndo( workingModel());
+        MS::showStatus("Smoothing cancelled.", 5000);
+        return Event::CANCEL;
+    }   // end if
     MS::showStatus("Finished smooth.", 5000);
     return _ev;
 }   // end doAfterAction
@@ -30,6 +30,7 @@ ActionUpdateU3D::ActionUpdateU3D() : FaceAction( "U3D Updater")
     addPurgeEvent( Event::MASK_CHANGE);
     addTriggerEvent( Event::MASK_CHANGE | Event::LOADED_MODEL);
     setAsync( true);
+    setReentrant( true);
 }   // end ctor
 
 
@@ -42,7 +43,7 @@ bool ActionUpdateU3D::isAllowed( Event)
 
 void ActionUpdateU3D::doAction( Event)
 {
-    U3DCache::refresh( MS::selectedModel(), true);
+    U3DCache::refresh( workingModel(), true);
 }   // end doAction
 
 
@@ -51,7 +52,7 @@ void ActionUpdateU3D::purge( const FM* fm) { U3DCache::purge(fm);}
 
 Event ActionUpdateU3D::doAfterAction( Event)
 {
-    const std::string fpath = U3DCache::u3dfilepath( MS::selectedModel())->toStdString();
+    const std::string fpath = U3DCache::u3dfilepath( workingModel())->toStdString();
 #ifndef NDEBUG
     std::cerr << "[INFO] FaceTools::Action::ActionUpdateU3D::doAfterAction: U3D cached at '" << fpath << "'" << std::endl;
 #endif
@@ -19,7 +19,7 @@
 #include <FaceModelViewer.h>
 #include <FaceModel.h>
 #include <QSignalBlocker>
-#include <QThread>
+#include <QElapsedTimer>
 #include <algorithm>
 #include <cassert>
 using FaceTools::Action::FaceActionWorker;
@@ -45,8 +45,8 @@ FaceAction::FaceAction( const QString& dn, const QIcon& ico, const QKeySequence&
 void FaceAction::_pinit()
 {
     _doasync = false;
-    _isWorking = false;
-    _worker = nullptr;
+    _reentrant = false;
+    _wfm = nullptr;
     _unlocked = true;
     _pevents = _tevents = _revents = Event::NONE;
     if ( _dname.isEmpty())
@@ -130,8 +130,35 @@ bool FaceAction::isTriggerEvent( Event e) const { return (_tevents & e) != Event
 bool FaceAction::isRefreshEvent( Event e) const { return (_revents & e) != Event::NONE;}
 
 
+bool FaceAction::isWorking( const FM *fm) const
+{
+    return _reentrant ? _working.count(fm) > 0 : !_working.empty();
+}   // end isWorking
+
+
 // protected
 void FaceAction::setAsync( bool async) { _doasync = async;}
+void FaceAction::setReentrant( bool reentrant) { _reentrant = reentrant;}
+
+
+// protected
+const FaceTools::FM* FaceAction::workingModel() const
+{
+    const FaceActionWorker *worker = FaceActionWorker::current();
+    if ( worker && worker->action() == this)
+        return worker->model();
+    return _wfm ? _wfm : MS::selectedModel();
+}   // end workingModel
+
+
+// protected
+FaceTools::CancelFn FaceAction::cancelFn() const
+{
+    const FaceActionWorker *worker = FaceActionWorker::current();
+    if ( worker && worker->action() == this)
+        return worker->cancelToken()->fn();
+    return nullptr;
+}   // end cancelFn
 
 
 void FaceAction::_init( QWidget* parent) // Called by FaceActionManager after constructor finished
@@ -178,23 +205,26 @@ void FaceAction::_init( QWidget* parent) // Called by FaceActionManager after co
 
 bool FaceAction::execute( Event e)
 {
-    if ( !isUnlocked() || !isAllowed(e))
+    const FM *fm = MS::selectedModel();
+    if ( isWorking( fm) || !isUnlocked() || !isAllowed(e))
         return false;
 
     _action.setEnabled(false);
     bool enteredDoAction = false;
+    _wfm = fm;
 
     if ( !doBeforeAction(e))  // Always in the GUI thread
     {
 #ifndef NDEBUG
         std::cerr << "Cancelled: " << debugName() << std::endl;
 #endif
+        _wfm = nullptr;
         refresh( e);
         emit onEvent( Event::CANCEL);
     }   // end if
     else
     {
-        _isWorking = true;
+        _working.insert( fm);
         enteredDoAction = true;
 
 #ifndef NDEBUG
@@ -203,21 +233,31 @@ bool FaceAction::execute( Event e)
         if ( isAsync())
         {
 #ifndef NDEBUG
-            std::cerr << " in new thread " << std::endl;
+            std::cerr << " on worker pool (queue depth " << FaceActionWorker::queueDepth() << ")" << std::endl;
 #endif
             if ( e == Event::USER)
                 MS::setLockSelected(true);
-            _worker = new FaceActionWorker( this, e);
-            connect( _worker, &FaceActionWorker::onWorkFinished, this, &FaceAction::_endExecute);
-            _worker->start();   // Asynchronous start
+            _wfm = nullptr;
+            FaceActionWorker *worker = new FaceActionWorker( this, e, fm);
+            // Finishing is queued back to the GUI thread where the worker is deleted.
+            connect( worker, &FaceActionWorker::onWorkFinished, this, [this, worker]( Event ev)
+            {
+                const FM *wfm = worker->model();
+                delete worker;
+                _endExecute( ev, wfm);
+            });
+            worker->start();   // Asynchronous start
         }   // end else
         else
         {
 #ifndef NDEBUG
             std::cerr << std::endl;
 #endif
+            QElapsedTimer timer;
+            timer.start();
             doAction(e);  // Blocks
-            _endExecute(e);
+            FaceActionWorker::recordTiming( this, 0, double(timer.nsecsElapsed()) / 1e6);
+            _endExecute(e, fm);
         }   // end else
     }   // end else
 
@@ -235,22 +275,20 @@ Event FaceAction::doAfterAction( Event e)
 
 void FaceAction::endNow()
 {
-    std::cerr << "ENDING NOW" << std::endl;
+    std::cerr << "[WARN] FaceTools::Action::FaceAction::endNow: " << debugName() << " timed out; cancelling." << std::endl;
 }   // end endNow
 
 
-// private slot
-void FaceAction::_endExecute( Event e)   // Always in GUI thread
+// private
+void FaceAction::_endExecute( Event e, const FM *fm)   // Always in GUI thread
 {
-    _isWorking = false;
-    if ( _worker)
-    {
-        delete _worker;
-        _worker = nullptr;
-    }   // end if
+    _working.erase( _working.find( fm));
+    if ( !FaceActionWorker::isUserWorking())
+        MS::setLockSelected(false);
 
-    MS::setLockSelected(false);
+    _wfm = fm;
     Event fev = doAfterAction( e);
+    _wfm = nullptr;
     _mpos = QPoint(-1,-1);
 #ifndef NDEBUG
     std::cerr << " Finished: " << debugName() << " did event(s) " << fev << std::endl;
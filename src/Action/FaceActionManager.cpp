@@ -24,6 +24,7 @@
 #include <Metric/MetricManager.h>
 #include <FaceModel.h>
 #include <Vis/FaceView.h>
+#include <QTimer>
 #include <functional>
 #include <cassert>
 using FaceTools::Action::FaceActionManager;
@@ -45,12 +46,12 @@ void pokeViewTransformsWithModel( const FM* fm)
 }   // end pokeViewTransformsWithModel
 
 
-// Rebuild the actors associated with the model.
-void rebuildViewActors( const FM* fm)
+// Update the actors associated with the model in place (rebuilding them only if necessary).
+void updateViewActors( const FM* fm)
 {
     for ( FaceTools::Vis::FV* fv : fm->fvs())
-        fv->reset();
-}   // end rebuildViewActors
+        fv->update();
+}   // end updateViewActors
 
 
 void applyFnToModels( const Event &e, const FM* fm, const std::function<void( const FM*)> &fn)
@@ -84,7 +85,7 @@ FaceActionManager::Ptr FaceActionManager::get( QWidget* parent)
 
 
 // private
-FaceActionManager::FaceActionManager()
+FaceActionManager::FaceActionManager() : _parent(nullptr), _scheduled(false), _suppressed(0)
 {
     const Interactor::SelectNotifier *sn = MS::selectNotifier();
     connect( sn, &Interactor::SelectNotifier::onSelected, [this]( Vis::FV*, bool s){ if ( s) this->doEvent( Event::MODEL_SELECT);});
@@ -99,6 +100,7 @@ QAction* FaceActionManager::registerAction( FaceAction* act)
     connect( act, &FaceAction::onEvent, &*get(), &FaceActionManager::doEvent);
     connect( act, &FaceAction::onShowHelp, [](const QString& tok){ emit get()->onShowHelp(tok);});
     acts.insert(act);
+    get()->_actionOrder.push_back(act);
     act->_init(s_singleton->_parent);
     act->addRefreshEvent( Event::MODEL_SELECT | Event::LOADED_MODEL | Event::CLOSED_MODEL);
     act->refresh();
@@ -159,13 +161,6 @@ void FaceActionManager::close( const FM* fm)
 
 void FaceActionManager::doEvent( Event E)
 {
-    const FM* fm = MS::selectedModel();
-    assert( fm || FMM::numOpen() == 0);
-    if ( E == Event::CANCEL)
-        return;
-
-    // The sending action should not be triggered by its own events (note that
-    // executed actions always refresh their own state upon completion).
     // NOTE sact may be null since a FaceAction may not be causing this call!
     FaceAction* sact = qobject_cast<FaceAction*>( sender());
 
@@ -174,19 +169,142 @@ void FaceActionManager::doEvent( Event E)
         std::cerr << "[WARNING]: " << E << " from " << sact->debugName() << std::endl;
 #endif
 
+    if ( sact)
+    {
+        // Release actions that were waiting on the sending action to finish. If the sent events
+        // trigger them anyway, they'll be triggered once in the next batch by both sets of events.
+        for ( auto it = _deferred.begin(); it != _deferred.end();)
+        {
+            it->second.awaiting.erase( sact);
+            if ( it->second.awaiting.empty())
+            {
+                _forced[it->first] |= it->second.events;
+                it = _deferred.erase(it);
+                _schedule();
+            }   // end if
+            else
+                ++it;
+        }   // end for
+
+        if ( E != Event::CANCEL && E != Event::NONE)
+            _emits[sact] |= E;
+    }   // end if
+
+    if ( E == Event::CANCEL)
+        return;
+
+    // Count executions saved by coalescing this event into the pending batch.
+    for ( const FaceAction* act : _actions)
+        if ( act != sact && act->isTriggerEvent(E) && act->isTriggerEvent( _eventsFor( act, _queue)))
+            _suppressed++;
+
+    _queue.push_back( SentEvent( sact, E));
+    _schedule();
+}   // end doEvent
+
+
+// private
+void FaceActionManager::_schedule()
+{
+    if ( !_scheduled)
+    {
+        _scheduled = true;
+        QTimer::singleShot( 0, this, &FaceActionManager::_processBatch);
+    }   // end if
+}   // end _schedule
+
+
+// private static
+Event FaceActionManager::_eventsFor( const FaceAction *act, const std::vector<SentEvent> &queue)
+{
+    // The sending action should not be triggered by its own events (note that
+    // executed actions always refresh their own state upon completion).
+    Event E = Event::NONE;
+    for ( const SentEvent &se : queue)
+        if ( se.first != act)
+            E |= se.second;
+    // Load events have to have an initial mesh change event
+    if ( has( E, Event::LOADED_MODEL))
+        E |= Event::MESH_CHANGE;
+    return E;
+}   // end _eventsFor
+
+
+// private
+std::vector<FaceAction*> FaceActionManager::_dependencyOrder() const
+{
+    // Action A precedes action B if A has been seen to emit events that trigger B.
+    // Otherwise actions are taken in registration order.
+    std::unordered_map<const FaceAction*, int> indeg;
+    for ( const FaceAction* b : _actionOrder)
+        indeg[b] = 0;
+    for ( const auto &p : _emits)
+        for ( const FaceAction* b : _actionOrder)
+            if ( b != p.first && b->isTriggerEvent( p.second))
+                indeg[b]++;
+
+    std::vector<FaceAction*> order;
+    order.reserve( _actionOrder.size());
+    std::unordered_set<const FaceAction*> done;
+    std::vector<FaceAction*> ready;  // FIFO (consumed from index next)
+    for ( FaceAction* act : _actionOrder)
+        if ( indeg.at(act) == 0)
+            ready.push_back( act);
+
+    for ( size_t next = 0; next < ready.size(); ++next)
+    {
+        FaceAction *a = ready[next];
+        order.push_back( a);
+        done.insert( a);
+        const auto it = _emits.find( a);
+        if ( it == _emits.end())
+            continue;
+        for ( FaceAction* b : _actionOrder)
+            if ( b != a && b->isTriggerEvent( it->second) && --indeg[b] == 0)
+                ready.push_back( b);
+    }   // end for
+
+    // Actions in cycles keep their registration order at the end.
+    if ( order.size() < _actionOrder.size())
+        for ( FaceAction* act : _actionOrder)
+            if ( done.count( act) == 0)
+                order.push_back( act);
+
+    return order;
+}   // end _dependencyOrder
+
+
+// private slot
+void FaceActionManager::_processBatch()
+{
+    _scheduled = false;
+    std::vector<SentEvent> queue;
+    queue.swap( _queue);
+    std::unordered_map<FaceAction*, Event> forced;
+    forced.swap( _forced);
+
+    const FM* fm = MS::selectedModel();
+    assert( fm || FMM::numOpen() == 0);
+
+    Event E = Event::NONE;   // All events in the batch
+    for ( const SentEvent &se : queue)
+        E |= se.second;
+    if ( has( E, Event::LOADED_MODEL))
+        E |= Event::MESH_CHANGE;
+
     if ( fm)
     {
         // Purge actions first.
         for ( FaceAction* act : _actions)
-            if ( act != sact && act->isPurgeEvent(E))
+            if ( act->isPurgeEvent( _eventsFor( act, queue)))
                 act->purge( fm);
 
-        // Geometry change events require rebuilding the actors associated with the affected FaceModels.
+        // Geometry change events require updating the actors associated with the affected FaceModels.
         // This also reapplies visualisations and it is necessary that any visualisations that rely upon
         // associations of data be fully purged first which is why the above loop to purge the actions
         // comes before this check.
         if ( has( E, Event::MESH_CHANGE | Event::ASSESSMENT_CHANGE | Event::RESTORE_CHANGE))
-            applyFnToModels( E, fm, rebuildViewActors);   // Also resets view normals
+            applyFnToModels( E, fm, updateViewActors);    // Also resets view normals
         else if ( has( E, Event::AFFINE_CHANGE))
             applyFnToModels( E, fm, pokeViewTransformsWithModel);
 
@@ -194,32 +312,73 @@ void FaceActionManager::doEvent( Event E)
             applyFnToModels( E, fm, MS::syncBoundingVisualisation);
     }   // end if
 
-    // Load events have to have an initial mesh change event
-    if ( has( E, Event::LOADED_MODEL))
-        E |= Event::MESH_CHANGE;
-
     MS::refreshHandlers();
 
     // Have actions recheck their own state and whether or not they're enabled, then see
-    // if the received event triggers them.
-    for ( FaceAction* act : _actions)
+    // if the batch's events trigger them. Actions started in this batch that are still
+    // running (asynchronous) are recorded so their dependents can wait on them.
+    std::unordered_set<const FaceAction*> running;
+    for ( FaceAction* act : _dependencyOrder())
     {
-        // Sending actions should not be able to trigger themselves, and
-        // actions are not reentrant generally speaking so running actions are also ignored.
-        if ( act == sact || act->isWorking())
+        // Actions are not reentrant generally speaking so running actions are ignored
+        // (unless reentrant and working on a different model).
+        if ( act->isWorking( fm))
             continue;
 
+        const auto fit = forced.find( act);
+        const Event fev = fit != forced.end() ? fit->second : Event::NONE;
+        const Event aev = _eventsFor( act, queue) | fev;
+
         // In refreshing state, actions decide whether to enable themselves and check themselves.
-        if ( act->isRefreshEvent(E) || act->isTriggerEvent(E) || act->isPurgeEvent(E))
-            act->refresh(E);
+        if ( act->isRefreshEvent(aev) || act->isTriggerEvent(aev) || act->isPurgeEvent(aev))
+            act->refresh(aev);
+
+        if ( !act->isEnabled() || (!act->isTriggerEvent(aev) && fev == Event::NONE))
+            continue;
 
-        if ( act->isEnabled() && act->isTriggerEvent(E))
+        assert( !has( aev, Event::NONE));
+        const Event tev = (act->triggerEvents() & aev) | fev;
+
+        // Hold back the action if it's already waiting, or if it will be triggered
+        // by a running action it depends on, or by events already queued for the next batch.
+        Deferral *d = nullptr;
+        const auto dit = _deferred.find( act);
+        if ( dit != _deferred.end())
+            d = &dit->second;
+        for ( const FaceAction* ract : running)
         {
-            assert( !has( E, Event::NONE));
-            act->execute(E);
+            if ( act->isTriggerEvent( _emits[ract]))
+            {
+                if ( !d)
+                    d = &_deferred[act];
+                d->awaiting.insert( ract);
+            }   // end if
+        }   // end for
+
+        if ( d)
+        {
+            d->events |= tev;
+            _suppressed++;
         }   // end if
+        else if ( act->isTriggerEvent( _eventsFor( act, _queue)))
+        {
+            _forced[act] |= tev;
+            _suppressed++;
+        }   // end else if
+        else if ( act->execute(tev) && act->isWorking())
+            running.insert( act);
     }   // end for
 
+#ifndef NDEBUG
+    static size_t s_reported = 0;
+    if ( _suppressed != s_reported)
+    {
+        std::cerr << "[INFO] FaceTools::Action::FaceActionManager::_processBatch: "
+                  << _suppressed << " duplicate action executions suppressed" << std::endl;
+        s_reported = _suppressed;
+    }   // end if
+#endif
+
     MS::updateRender();
     emit onUpdateSelected();
-}   // end doEvent
+}   // end _processBatch
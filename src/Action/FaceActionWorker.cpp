@@ -18,25 +18,40 @@
 #include <Action/FaceActionWorker.h>
 #include <Action/FaceAction.h>
 #include <Action/ModelSelector.h>
+#include <algorithm>
+#include <cassert>
 using FaceTools::Action::FaceActionWorker;
 using FaceTools::Action::FaceAction;
 using FaceTools::Action::Event;
+using FaceTools::CancelToken;
 using MS = FaceTools::Action::ModelSelector;
 
 
-int FaceActionWorker::_s_userWorkCount(0);
+std::atomic<int> FaceActionWorker::_s_userWorkCount(0);
+std::atomic<int> FaceActionWorker::_s_queued(0);
+std::atomic<int> FaceActionWorker::_s_running(0);
+std::atomic<int> FaceActionWorker::_s_timeout(0);
 QMutex FaceActionWorker::_s_mutex;
+std::unordered_map<std::string, FaceActionWorker::Timing> FaceActionWorker::_s_timings;
 
 
-FaceActionWorker::FaceActionWorker( FaceAction* worker, Event e)
-    : QThread(worker), _worker(worker), _event(e), _timer(nullptr), _tcount(0)
+namespace {
+thread_local FaceActionWorker *t_current = nullptr;
+
+double msSince( const std::chrono::steady_clock::time_point &t0)
+{
+    return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - t0).count();
+}   // end msSince
+}   // end namespace
+
+
+FaceActionWorker::FaceActionWorker( FaceAction* worker, Event e, const FM *fm)
+    : QObject(worker), _worker(worker), _event(e), _fm(fm), _timer(nullptr), _tcount(0), _token( CancelToken::create())
 {
+    setAutoDelete(false);
     if ( e == Event::USER)
     {
-        _s_mutex.lock();
         _s_userWorkCount++;
-        _s_mutex.unlock();
-
         MS::setCursor( Qt::CursorShape::BusyCursor);
         _tcount = 0;
         _timer = new QTimer(this);
@@ -54,38 +69,98 @@ FaceActionWorker::~FaceActionWorker()
 
     if ( _event == Event::USER)
     {
-        _s_mutex.lock();
         _s_userWorkCount--;
         assert( _s_userWorkCount >= 0);
-        _s_mutex.unlock();
-
         MS::restoreCursor();
         MS::clearStatus();
     }   // end if
 }   // end dtor
 
 
+// static
+QThreadPool* FaceActionWorker::pool()
+{
+    static QThreadPool s_pool;
+    return &s_pool;
+}   // end pool
+
+
+// static
+FaceActionWorker* FaceActionWorker::current() { return t_current;}
+
+
+void FaceActionWorker::start()
+{
+    _queuedAt = Clock::now();
+    _s_queued++;
+    pool()->start( this);
+}   // end start
+
+
 void FaceActionWorker::run()    // thread function
 {
+    _s_queued--;
+    _s_running++;
+    const double waitMs = msSince( _queuedAt);
+    const Clock::time_point t0 = Clock::now();
+    const int tout = _s_timeout;
+    if ( tout > 0)
+        _token->setDeadline( 1000 * tout);
+
+    t_current = this;
     _worker->doAction( _event);
+    t_current = nullptr;
+
+    recordTiming( _worker, waitMs, msSince( t0));
+    _s_running--;
     emit onWorkFinished( _event);
 }   // end run
 
 
+// static
+void FaceActionWorker::recordTiming( const FaceAction *act, double waitMs, double runMs)
+{
+    _s_mutex.lock();
+    Timing &t = _s_timings[act->debugName()];
+    t.runs++;
+    t.waitMs += waitMs;
+    t.maxWaitMs = std::max( t.maxWaitMs, waitMs);
+    t.runMs += runMs;
+    t.maxRunMs = std::max( t.maxRunMs, runMs);
+    _s_mutex.unlock();
+}   // end recordTiming
+
+
+// static
+std::unordered_map<std::string, FaceActionWorker::Timing> FaceActionWorker::timings()
+{
+    _s_mutex.lock();
+    const std::unordered_map<std::string, Timing> t = _s_timings;
+    _s_mutex.unlock();
+    return t;
+}   // end timings
+
+
+// static
+void FaceActionWorker::resetTimings()
+{
+    _s_mutex.lock();
+    _s_timings.clear();
+    _s_mutex.unlock();
+}   // end resetTimings
+
+
 void FaceActionWorker::_doOnTimerInterval()
 {
-    static const int MAX_TIME_OUT = 60;  // seconds
     _tcount++;
-    if ( _tcount == MAX_TIME_OUT)
+    const int tout = _s_timeout;
+    if ( tout > 0 && _tcount >= tout)
     {
         requestInterruption();
-//        _status += " timed out!";
         _deleteTimer();
         _worker->endNow();
     }   // end if
-    else if ( _tcount < MAX_TIME_OUT)
-        _status += ".";
-    MS::showStatus( _status);
+    MS::showStatus( _status + QString( (_tcount - 1) % 10 + 1, '.'));    // Cycle the progress dots
 }   // end _doOnTimerInterval
 
 
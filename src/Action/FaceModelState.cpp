@@ -32,18 +32,35 @@ FaceModelState::Ptr FaceModelState::create( FM* fm, Event e)
 
 void FaceModelState::_saveMesh()
 {
-    _mesh = _fm->_mesh;
+    _mesh = MeshSnapshot::create( _fm->_mesh);
     _kdtree = _fm->_kdtree;
     _manifolds = _fm->_manifolds;
 }   // end _saveMesh
 
 
+bool FaceModelState::encodeMesh( const MeshSnapshot &ms)
+{
+    if ( !_mesh || !_mesh->encode( ms))
+        return false;
+    _kdtree = nullptr;      // Both may reference the mesh
+    _manifolds = nullptr;
+    return true;
+}   // end encodeMesh
+
+
 void FaceModelState::_restoreMesh() const
 {
     assert(_mesh);
-    _fm->_mesh = _mesh;
-    _fm->_kdtree = _kdtree;
-    _fm->_manifolds = _manifolds;
+    if ( _mesh->isDelta())
+        _fm->update( _mesh->mesh(), true, false);   // Rebuilds the KD-tree and manifolds
+    else
+    {
+        // The mesh itself so the saved KD-tree and manifolds still apply. If it was transformed
+        // in place since, its transform is restored along with the affine state (if saved).
+        _fm->_mesh = _mesh->sharedMesh();
+        _fm->_kdtree = _kdtree;
+        _fm->_manifolds = _manifolds;
+    }   // end else
 }   // end _restoreMesh
 
 
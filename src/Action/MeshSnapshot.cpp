@@ -0,0 +1,165 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <Action/MeshSnapshot.h>
+#include <cstring>
+#include <cassert>
+using FaceTools::Action::MeshSnapshot;
+using FaceTools::Vec3f;
+
+
+namespace {
+
+bool sameTexture( const r3d::Mesh &m0, const r3d::Mesh &m1)
+{
+    const cv::Mat t0 = m0.texture( *m0.materialIds().begin());
+    const cv::Mat t1 = m1.texture( *m1.materialIds().begin());
+    if ( t0.data == t1.data)
+        return true;
+    if ( t0.size() != t1.size() || t0.type() != t1.type() || !t0.isContinuous() || !t1.isContinuous())
+        return false;
+    return memcmp( t0.data, t1.data, t0.total() * t0.elemSize()) == 0;
+}   // end sameTexture
+
+
+// Returns true iff the two meshes have the same sequential vertex IDs, faces (with the same
+// vertex ordering and texture coordinates) and texture so that they differ at most by vertex position.
+bool sameTopology( const r3d::Mesh &m0, const r3d::Mesh &m1)
+{
+    if ( !m0.hasSequentialIds() || !m1.hasSequentialIds()
+      || m0.numVtxs() != m1.numVtxs() || m0.numFaces() != m1.numFaces()
+      || m0.hasMaterials() != m1.hasMaterials())
+        return false;
+
+    const int nf = int(m0.numFaces());
+    for ( int fid = 0; fid < nf; ++fid)
+    {
+        const int *f0 = m0.fvidxs(fid);
+        const int *f1 = m1.fvidxs(fid);
+        if ( f0[0] != f1[0] || f0[1] != f1[1] || f0[2] != f1[2])
+            return false;
+    }   // end for
+
+    if ( m0.hasMaterials())
+    {
+        for ( int fid = 0; fid < nf; ++fid)
+            for ( int j = 0; j < 3; ++j)
+                if ( m0.faceUV( fid, j) != m1.faceUV( fid, j))
+                    return false;
+        if ( !sameTexture( m0, m1))
+            return false;
+    }   // end if
+
+    return true;
+}   // end sameTopology
+
+}   // end namespace
+
+
+MeshSnapshot::Ptr MeshSnapshot::create( r3d::Mesh::Ptr mesh)
+{
+    assert( mesh);
+    return Ptr( new MeshSnapshot( mesh), [](MeshSnapshot* x){ delete x;});
+}   // end create
+
+
+MeshSnapshot::Ptr MeshSnapshot::create( const FM *fm)
+{
+    // Safe to share since the model only ever replaces its mesh.
+    return create( std::const_pointer_cast<r3d::Mesh>( fm->meshPtr()));
+}   // end create
+
+
+MeshSnapshot::MeshSnapshot( r3d::Mesh::Ptr mesh) : _mesh(mesh), _tmat( mesh->transformMatrix()) {}
+
+
+r3d::Mesh::Ptr MeshSnapshot::mesh() const
+{
+    if ( !_base)
+    {
+        if ( _mesh->transformMatrix().isApprox( _tmat))
+            return _mesh;
+        // Transformed in place since the snapshot was taken so copy out with the original transform.
+        r3d::Mesh::Ptr mesh = _mesh->deepCopy();
+        mesh->addTransformMatrix( _tmat * mesh->inverseTransformMatrix());
+        return mesh;
+    }   // end if
+
+    r3d::Mesh::Ptr mesh = _base->deepCopy();
+    size_t j = 0;
+    for ( const std::pair<int,int> &r : _ranges)
+        for ( int i = 0; i < r.second; ++i)
+            mesh->adjustRawVertex( r.first + i, _vpos[j++]);
+    if ( !mesh->transformMatrix().isApprox( _tmat))
+        mesh->addTransformMatrix( _tmat * mesh->inverseTransformMatrix());
+    return mesh;
+}   // end mesh
+
+
+bool MeshSnapshot::encode( const MeshSnapshot &ms)
+{
+    if ( _base || ms._base || _mesh == ms._mesh || !sameTopology( *_mesh, *ms._mesh))
+        return false;
+
+    std::vector<std::pair<int,int> > ranges;
+    std::vector<Vec3f> vpos;
+    const int nv = int(_mesh->numVtxs());
+    for ( int vidx = 0; vidx < nv; ++vidx)
+    {
+        const Vec3f &v = _mesh->uvtx(vidx);
+        if ( v == ms._mesh->uvtx(vidx))
+            continue;
+        if ( !ranges.empty() && ranges.back().first + ranges.back().second == vidx)
+            ranges.back().second++;
+        else
+            ranges.push_back( std::pair<int,int>( vidx, 1));
+        vpos.push_back( v);
+    }   // end for
+
+    const size_t dbytes = ranges.size() * sizeof(std::pair<int,int>) + vpos.size() * sizeof(Vec3f);
+    if ( dbytes >= meshBytes( *_mesh))
+        return false;
+
+    _ranges.swap( ranges);
+    _vpos.swap( vpos);
+    _base = ms._mesh;
+    _mesh = nullptr;
+    return true;
+}   // end encode
+
+
+size_t MeshSnapshot::deltaBytes() const
+{
+    if ( !_base)
+        return 0;
+    return sizeof(Mat4f) + _ranges.size() * sizeof(std::pair<int,int>) + _vpos.size() * sizeof(Vec3f);
+}   // end deltaBytes
+
+
+size_t MeshSnapshot::meshBytes( const r3d::Mesh &mesh)
+{
+    // Raw and transformed positions plus vertex to face connectivity, then
+    // face vertices plus per face normals, texture coordinates and lookups.
+    size_t nbytes = mesh.numVtxs() * (2*sizeof(Vec3f) + 8*sizeof(int))
+                  + mesh.numFaces() * (3*sizeof(int) + sizeof(Vec3f) + 3*sizeof(Vec2f) + 4*sizeof(int));
+    if ( mesh.hasMaterials())
+    {
+        const cv::Mat tx = mesh.texture( *mesh.materialIds().begin());
+        nbytes += tx.total() * tx.elemSize();
+    }   // end if
+    return nbytes;
+}   // end meshBytes
@@ -37,6 +37,16 @@ void FaceTools::Action::scrapLastUndo( const FM *fm)
 }   // end scrapLastUndo
 
 
+Event FaceTools::Action::rollbackLastUndo( const FM *fm)
+{
+    return UndoStates::rollbackLastUndo( fm);
+}   // end rollbackLastUndo
+
+
+// static definitions
+size_t UndoState::s_seq(0);
+
+
 UndoState::Ptr UndoState::create( const FaceAction* a, Event egrp, bool autoRestore)
 {
     return Ptr( new UndoState(a, egrp, autoRestore), [](UndoState* x){ delete x;});
@@ -45,7 +55,8 @@ UndoState::Ptr UndoState::create( const FaceAction* a, Event egrp, bool autoRest
 
 UndoState::UndoState( const FaceAction* a, Event egrp, bool ar)
     : _action( const_cast<FaceAction*>(a)), _egrp(egrp), _autoRestore(ar),
-      _name(a->displayName()), _sfm( MS::selectedModel()) // Could be null
+      _name(a->displayName()), _sfm( MS::selectedModel()), // Could be null
+      _seq( s_seq++)
 {
     // If auto-restoring, backup the needed data elements otherwise the setUserData function will be used.
     if ( isAutoRestore())
@@ -84,6 +95,63 @@ QVariant UndoState::userData( const QString& s) const
 }   // end userData
 
 
+void UndoState::setMesh( const QString& s, r3d::Mesh::Ptr mesh)
+{
+    _umeshes[s] = MeshSnapshot::create( mesh);
+}   // end setMesh
+
+
+r3d::Mesh::Ptr UndoState::mesh( const QString& s) const
+{
+    assert( _umeshes.contains(s));
+    return _umeshes[s]->mesh();
+}   // end mesh
+
+
+std::vector<FaceTools::Action::MeshSnapshot::Ptr> UndoState::snapshots() const
+{
+    std::vector<MeshSnapshot::Ptr> snaps;
+    for ( const FaceModelState::Ptr &fstate : _fstates)
+        if ( fstate->meshSnapshot())
+            snaps.push_back( fstate->meshSnapshot());
+    for ( const MeshSnapshot::Ptr &ms : _umeshes)
+        snaps.push_back( ms);
+    return snaps;
+}   // end snapshots
+
+
+bool UndoState::encode( const UndoState &us)
+{
+    const std::vector<MeshSnapshot::Ptr> nsnaps = us.snapshots();
+    bool encoded = false;
+    for ( FaceModelState::Ptr &fstate : _fstates)
+    {
+        for ( const MeshSnapshot::Ptr &ms : nsnaps)
+        {
+            if ( fstate->encodeMesh( *ms))
+            {
+                encoded = true;
+                break;
+            }   // end if
+        }   // end for
+    }   // end for
+
+    for ( MeshSnapshot::Ptr &ums : _umeshes)
+    {
+        for ( const MeshSnapshot::Ptr &ms : nsnaps)
+        {
+            if ( ums->encode( *ms))
+            {
+                encoded = true;
+                break;
+            }   // end if
+        }   // end for
+    }   // end for
+
+    return encoded;
+}   // end encode
+
+
 Event UndoState::restore() const
 {
     assert(_action != nullptr);
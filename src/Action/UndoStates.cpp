@@ -18,9 +18,11 @@
 #include <Action/UndoStates.h>
 #include <Action/FaceAction.h>
 #include <QThread>
+#include <unordered_set>
 #include <cassert>
 using FaceTools::Action::UndoStates;
 using FaceTools::Action::UndoState;
+using FaceTools::Action::MeshSnapshot;
 using FaceTools::Action::FaceAction;
 using FaceTools::Action::Event;
 using FaceTools::FM;
@@ -38,6 +40,107 @@ UndoStates::Ptr UndoStates::get()
 }   // end get
 
 
+void UndoStates::setMemoryBudget( size_t nbytes)
+{
+    Ptr ustates = get();
+    ustates->_mutex.lockForWrite();
+    ustates->_budget = nbytes;
+    ustates->_evict( nullptr);
+    ustates->_mutex.unlock();
+    emit ustates->onUpdated();
+}   // end setMemoryBudget
+
+
+size_t UndoStates::memoryBudget() { return get()->_budget;}
+
+
+size_t UndoStates::memoryUsage( const FM *fm)
+{
+    Ptr ustates = get();
+    ustates->_mutex.lockForRead();
+    const size_t nbytes = fm ? ustates->_memoryUsage( fm) : ustates->_memoryUsage();
+    ustates->_mutex.unlock();
+    return nbytes;
+}   // end memoryUsage
+
+
+size_t UndoStates::_memoryUsage( const FM *fm) const
+{
+    const auto it = _stacks.find(fm);
+    if ( it == _stacks.end())
+        return 0;
+
+    // Meshes still in use by the models aren't held only by the undo states
+    std::unordered_set<const r3d::Mesh*> counted;
+    for ( const auto &p : _stacks)
+        if ( p.first)
+            counted.insert( p.first->meshPtr().get());
+
+    size_t nbytes = 0;
+    const auto countMesh = [&]( const r3d::Mesh *mesh)
+    {
+        if ( mesh && counted.insert( mesh).second)
+            nbytes += MeshSnapshot::meshBytes( *mesh);
+    };  // end countMesh
+
+    std::unordered_set<const UndoState*> ucounted;
+    const auto countStates = [&]( const std::deque<UndoState::Ptr> &ustates)
+    {
+        for ( const UndoState::Ptr &us : ustates)
+        {
+            if ( !ucounted.insert( us.get()).second)
+                continue;
+            for ( const MeshSnapshot::Ptr &ms : us->snapshots())
+            {
+                countMesh( ms->full());
+                countMesh( ms->base());
+                nbytes += ms->deltaBytes();
+            }   // end for
+        }   // end for
+    };  // end countStates
+
+    const Stacks &stacks = it->second;
+    countStates( stacks.undos);
+    countStates( stacks.redos);
+    countStates( stacks.oldRedos);
+    return nbytes;
+}   // end _memoryUsage
+
+
+size_t UndoStates::_memoryUsage() const
+{
+    size_t nbytes = 0;
+    for ( const auto &p : _stacks)
+        nbytes += _memoryUsage( p.first);
+    return nbytes;
+}   // end _memoryUsage
+
+
+void UndoStates::_evict( const UndoState *keep)
+{
+    while ( _memoryUsage() > _budget)
+    {
+        // Find the stacks with the oldest undo state
+        Stacks *ostacks = nullptr;
+        for ( auto &p : _stacks)
+        {
+            Stacks &stacks = p.second;
+            if ( stacks.undos.empty() || stacks.undos.back().get() == keep)
+                continue;
+            if ( !ostacks || stacks.undos.back()->_seq < ostacks->undos.back()->_seq)
+                ostacks = &stacks;
+        }   // end for
+
+        if ( !ostacks)
+            break;
+#ifndef NDEBUG
+        std::cerr << "UndoStates::_evict: evicting '" << ostacks->undos.back()->name().toStdString() << "'" << std::endl;
+#endif
+        ostacks->undos.pop_back();
+    }   // end while
+}   // end _evict
+
+
 void UndoStates::clear( const FM* fm) { get()->_clear(fm);}
 void UndoStates::_clear( const FM* fm)
 {
@@ -65,8 +168,11 @@ void UndoStates::_storeUndo( const FaceAction* a, Event e, bool autoRestore)
     if ( stacks.undos.size() == MAX_RESTORES)
         stacks.undos.pop_back();
     stacks.undos.push_front( us);   // Push to undo stack
+    if ( stacks.undos.size() > 1)   // The previous state's meshes need only store their differences to this state's
+        stacks.undos[1]->encode( *us);
     stacks.oldRedos = stacks.redos; // In case of scrapping - can roll back
     stacks.redos.clear(); // Clear the redo stack
+    _evict( us.get());
     _mutex.unlock();
     emit onUpdated();
 }   // end _storeUndo
@@ -87,6 +193,24 @@ void UndoStates::_scrapLastUndo( const FM *fm)
 }   // end _scrapLastUndo
 
 
+Event UndoStates::rollbackLastUndo( const FM *fm) { return get()->_rollbackLastUndo( fm);}
+Event UndoStates::_rollbackLastUndo( const FM *fm)
+{
+    assert( _canUndo( fm));
+    _mutex.lockForWrite();
+    Stacks& stacks = _stacks.at(fm);
+    UndoState::Ptr ustate = stacks.undos.front();
+    stacks.undos.pop_front();
+    stacks.redos = stacks.oldRedos;
+    stacks.oldRedos.clear();
+    _mutex.unlock();
+
+    const Event e = ustate->restore();
+    emit onUpdated();
+    return e;
+}   // end _rollbackLastUndo
+
+
 bool UndoStates::canUndo() { return get()->_canUndo( MS::selectedModel());}
 bool UndoStates::_canUndo( const FM *fm)
 {
@@ -171,6 +295,8 @@ Event UndoStates::_redo( const FM *fm)
     if ( !rstate->isAutoRestore())
         rstate->action()->saveState( *ustate);
     stacks.undos.push_front( ustate);
+    if ( stacks.undos.size() > 1)
+        stacks.undos[1]->encode( *ustate);
     _mutex.unlock();
 
     Event e = rstate->restore();
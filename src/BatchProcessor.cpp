@@ -0,0 +1,272 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <BatchProcessor.h>
+#include <Action/ActionAlignModel.h>
+#include <Action/ActionDetectFace.h>
+#include <Action/ActionUpdateMeasurements.h>
+#include <FileIO/FaceModelManager.h>
+#include <FileIO/FaceModelFileData.h>
+#include <LndMrk/LandmarksManager.h>
+#include <Metric/PhenotypeManager.h>
+#include <FaceModelCurvature.h>
+#include <MaskRegistration.h>
+#include <MiscFunctions.h>
+#include <FaceModel.h>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
+#include <QDir>
+#include <iomanip>
+#include <fstream>
+#include <thread>
+using FaceTools::BatchProcessor;
+using FaceTools::FM;
+using FMM = FaceTools::FileIO::FaceModelManager;
+using FMC = FaceTools::FaceModelCurvature;
+using LMAN = FaceTools::Landmark::LandmarksManager;
+using PM = FaceTools::Metric::PhenotypeManager;
+
+namespace {
+QMutex s_renderLock;    // Texture alignment renders through an offscreen VTK viewer which is not thread safe
+}   // end namespace
+
+
+const char* BatchProcessor::stageName( Stage s)
+{
+    static const char* NAMES[NUM_STAGES] = {"Load", "Align", "Detect", "Measure", "Phenotypes", "Save"};
+    return NAMES[s];
+}   // end stageName
+
+
+BatchProcessor::Params::Params()
+    : numThreads(0), align(true), detect(true), measure(true), phenotypes(true), writeCSV(false), modelDeadline(-1) {}
+
+
+BatchProcessor::Report::Report()
+    : numModels(0), numFailed(0), elapsed(0), numPhenotypes(0)
+{
+    for ( int i = 0; i < NUM_STAGES; ++i)
+    {
+        stageSecs[i] = 0;
+        stageCount[i] = 0;
+    }   // end for
+}   // end ctor
+
+
+double BatchProcessor::Report::modelsPerSecond() const
+{
+    return elapsed > 0 ? double(numModels - numFailed) / elapsed : 0;
+}   // end modelsPerSecond
+
+
+double BatchProcessor::Report::meanLatency( Stage s) const
+{
+    return stageCount[s] > 0 ? 1000 * stageSecs[s] / stageCount[s] : 0;
+}   // end meanLatency
+
+
+void BatchProcessor::Report::print( std::ostream &os) const
+{
+    os << "Processed " << (numModels - numFailed) << " of " << numModels << " models in "
+       << std::fixed << std::setprecision(2) << elapsed << " secs ("
+       << modelsPerSecond() << " models/sec)" << std::endl;
+    for ( int i = 0; i < NUM_STAGES; ++i)
+    {
+        const Stage s = Stage(i);
+        if ( stageCount[s] == 0)
+            continue;
+        os << "  " << std::left << std::setw(12) << stageName(s) << std::right
+           << std::setw(10) << meanLatency(s) << " ms/model (" << stageCount[s] << " runs)" << std::endl;
+    }   // end for
+    os << "  " << numPhenotypes << " phenotypic indications discovered" << std::endl;
+}   // end print
+
+
+BatchProcessor::BatchProcessor( const Params &p) : _params(p) {}
+
+
+const BatchProcessor::Report& BatchProcessor::process( const QStringList &fpaths)
+{
+    _report = Report();
+    _failed.clear();
+    _report.numModels = size_t(fpaths.size());
+
+    if ( !_params.outDir.isEmpty() && !QDir().mkpath( _params.outDir))
+    {
+        std::cerr << "[WARN] FaceTools::BatchProcessor::process: Unable to create output directory!" << std::endl;
+        _params.outDir = "";
+    }   // end if
+
+    size_t nthreads = _params.numThreads;
+    if ( nthreads == 0)
+        nthreads = size_t(std::max( 1, QThread::idealThreadCount()));
+    nthreads = std::min( nthreads, size_t(fpaths.size()));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Share the cores between workers for the parallel work (curvature, phenotype discovery) each does
+    const size_t nchunkThreads = std::max<size_t>( 1, size_t(std::max( 1, QThread::idealThreadCount())) / nthreads);
+
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    for ( size_t i = 0; i < nthreads; ++i)
+        workers.push_back( std::thread( &BatchProcessor::_work, this, std::cref(fpaths), std::ref(next), nchunkThreads));
+    for ( std::thread &t : workers)
+        t.join();
+
+    _report.elapsed = double(timer.nsecsElapsed()) * 1e-9;
+    return _report;
+}   // end process
+
+
+void BatchProcessor::_work( const QStringList &fpaths, std::atomic<int> &next, size_t nchunkThreads)
+{
+    setParallelChunksThreads( nchunkThreads);
+    int i;
+    while ( (i = next++) < fpaths.size())
+        _processFile( fpaths.at(i));
+}   // end _work
+
+
+void BatchProcessor::_addTiming( Stage s, qint64 nsecs)
+{
+    _rlock.lock();
+    _report.stageSecs[s] += double(nsecs) * 1e-9;
+    _report.stageCount[s]++;
+    _rlock.unlock();
+}   // end _addTiming
+
+
+void BatchProcessor::_setFailed( const QString &fpath, const QString &err)
+{
+    _rlock.lock();
+    _failed[fpath] = err;
+    _report.numFailed++;
+    _rlock.unlock();
+#ifndef NDEBUG
+    std::cerr << "[WARN] FaceTools::BatchProcessor: " << fpath.toStdString() << ": " << err.toStdString() << std::endl;
+#endif
+}   // end _setFailed
+
+
+void BatchProcessor::_processFile( const QString &fpath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    FM *fm = FMM::read( fpath);
+    _addTiming( LOAD, timer.nsecsElapsed());
+
+    if ( !fm)
+    {
+        _setFailed( fpath, FMM::error());
+        return;
+    }   // end if
+
+    QString failReason;
+    fm->lockForWrite();
+
+    // The heavy stages stop early once the model's deadline passes. Partial results are
+    // discarded and the model fails (so is never saved).
+    const CancelFn cfn = CancelToken::create( _params.modelDeadline)->fn();
+    static const QString DEADLINE_MSG = "Deadline exceeded!";
+
+    if ( _params.align)
+    {
+        timer.restart();
+        FMC::purge( fm);
+        if ( FMC::add( fm, nullptr, cfn))    // Geometric alignment requires vertex normals
+        {
+            if ( fm->hasTexture())
+            {
+                s_renderLock.lock();
+                Action::ActionAlignModel::align( fm);
+                s_renderLock.unlock();
+            }   // end if
+            else
+                Action::ActionAlignModel::align( fm);
+            fm->fixTransformMatrix();
+        }   // end if
+        else
+            failReason = DEADLINE_MSG;
+        FMC::purge( fm);
+        _addTiming( ALIGN, timer.nsecsElapsed());
+    }   // end if
+
+    if ( failReason.isEmpty() && _params.detect)
+    {
+        if ( !MaskRegistration::maskLoaded())
+            failReason = "Mask not loaded!";
+        else if ( !fm->mesh().hasSequentialIds())
+            failReason = "Model does not have sequential vertex IDs!";
+        else
+        {
+            timer.restart();
+            // Alignment (if requested) was done in the previous stage
+            if ( !Action::ActionDetectFace::detect( fm, LMAN::ids(), cfn, false))
+                failReason = DEADLINE_MSG;
+            _addTiming( DETECT, timer.nsecsElapsed());
+        }   // end else
+    }   // end if
+
+    if ( failReason.isEmpty() && _params.measure)
+    {
+        timer.restart();
+        Action::ActionUpdateMeasurements::updateAllMeasurements( fm);
+        _addTiming( MEASURE, timer.nsecsElapsed());
+    }   // end if
+
+    if ( failReason.isEmpty() && _params.phenotypes)
+    {
+        timer.restart();
+        const IntSet pids = PM::discover( fm);
+        _addTiming( PHENOTYPES, timer.nsecsElapsed());
+        _rlock.lock();
+        _report.numPhenotypes += pids.size();
+        _rlock.unlock();
+    }   // end if
+
+    if ( failReason.isEmpty() && !_params.outDir.isEmpty())
+    {
+        timer.restart();
+        const QFileInfo finfo( fpath);
+        QString savepath = QDir(_params.outDir).filePath( finfo.completeBaseName() + "." + FMM::fileFormats().preferredExt());
+        if ( !FMM::write( fm, savepath))
+            failReason = FMM::error();
+
+        if ( failReason.isEmpty() && _params.writeCSV)
+        {
+            const QString csvpath = QDir(_params.outDir).filePath( finfo.completeBaseName() + ".csv");
+            std::ofstream ofs( csvpath.toLocal8Bit().toStdString());
+            if ( ofs.good())
+                FileIO::FaceModelFileData( *fm).toCSV( ofs);
+            else
+                failReason = "Unable to write " + csvpath;
+        }   // end if
+        _addTiming( SAVE, timer.nsecsElapsed());
+    }   // end if
+
+    fm->unlock();
+
+    if ( !failReason.isEmpty())
+        _setFailed( fpath, failReason);
+
+    FMC::purge( fm);
+    FMM::close( fm);
+}   // end _processFile
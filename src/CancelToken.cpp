@@ -0,0 +1,54 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <CancelToken.h>
+using FaceTools::CancelToken;
+using FaceTools::CancelFn;
+
+
+CancelToken::Ptr CancelToken::create( int msecs)
+{
+    Ptr tok( new CancelToken);
+    tok->setDeadline( msecs);
+    return tok;
+}   // end create
+
+
+CancelToken::CancelToken() : _cancelled(false), _hasDeadline(false), _deadline(0) {}
+
+
+void CancelToken::setDeadline( int msecs)
+{
+    if ( msecs >= 0)
+        _deadline = (Clock::now() + std::chrono::milliseconds( msecs)).time_since_epoch().count();
+    _hasDeadline = msecs >= 0;
+}   // end setDeadline
+
+
+bool CancelToken::isCancelled() const
+{
+    if ( _cancelled)
+        return true;
+    return _hasDeadline && Clock::now().time_since_epoch().count() >= _deadline;
+}   // end isCancelled
+
+
+CancelFn CancelToken::fn() const
+{
+    std::shared_ptr<const CancelToken> tok = shared_from_this();
+    return [tok](){ return tok->isCancelled();};
+}   // end fn
@@ -0,0 +1,351 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <CurvatureMap.h>
+#include <MiscFunctions.h>
+#include <Action/FaceActionWorker.h>
+#include <Eigen/Eigenvalues>
+#include <QThread>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+using FaceTools::CurvatureMap;
+using FaceTools::Vec3f;
+using FaceTools::Mat3f;
+using FaceTools::IntSet;
+
+
+namespace {
+
+std::vector<int> sortedIds( const FaceTools::IntSet &ids)
+{
+    std::vector<int> sids( ids.begin(), ids.end());
+    std::sort( sids.begin(), sids.end());   // Neighbouring IDs tend to be neighbouring in memory
+    return sids;
+}   // end sortedIds
+
+
+// Call fn on each of the given IDs in blocks with the IDs within each block processed in
+// parallel. Progress is reported and cancellation checked between blocks with progress
+// over all the IDs mapped to [p0,p1]. Returns false iff cancelled.
+bool processBlocks( const std::vector<int> &ids, const std::function<void( int)> &fn,
+                    const CurvatureMap::ProgressFn &pfn, const CurvatureMap::CancelFn &cfn, float p0, float p1)
+{
+    static const size_t BLOCK_SIZE = 16384;
+    const size_t n = ids.size();
+    for ( size_t b0 = 0; b0 < n; b0 += BLOCK_SIZE)
+    {
+        if ( cfn && cfn())
+            return false;
+        const size_t b1 = std::min( n, b0 + BLOCK_SIZE);
+        FaceTools::parallelChunks( b1 - b0, [&]( size_t i0, size_t i1)
+        {
+            for ( size_t i = b0 + i0; i < b0 + i1; ++i)
+                fn( ids[i]);
+        }, 1024);
+        if ( pfn)
+            pfn( p0 + (p1 - p0) * float(b1) / n);
+    }   // end for
+    return !(cfn && cfn());
+}   // end processBlocks
+
+
+int maxId( const std::vector<int> &sids) { return sids.empty() ? 0 : sids.back() + 1;}
+
+
+// Hash vertex positions on their exact bit patterns since matched vertices are copies.
+struct PosHash
+{
+    size_t operator()( const Vec3f &v) const
+    {
+        size_t h = 0;
+        for ( int i = 0; i < 3; ++i)
+        {
+            uint32_t b;
+            memcpy( &b, &v[i], sizeof(b));
+            h ^= std::hash<uint32_t>()(b) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        }   // end for
+        return h;
+    }   // end operator()
+};  // end struct
+
+
+// Returns the ID of the face in mesh having the given vertices in the same winding order or -1 if none.
+int findFace( const r3d::Mesh &mesh, int v0, int v1, int v2)
+{
+    for ( int fid : mesh.faces( v0))
+    {
+        const int *fvidxs = mesh.fvidxs( fid);
+        const int k = fvidxs[0] == v0 ? 0 : (fvidxs[1] == v0 ? 1 : 2);
+        if ( fvidxs[(k+1)%3] == v1 && fvidxs[(k+2)%3] == v2)
+            return fid;
+    }   // end for
+    return -1;
+}   // end findFace
+
+}   // end namespace
+
+
+CurvatureMap::Ptr CurvatureMap::create( const r3d::Mesh &mesh, const ProgressFn &pfn, const CancelFn &cfn)
+{
+    Ptr cmap( new CurvatureMap);
+    if ( !cmap->_build( mesh, pfn, cfn))
+        cmap = nullptr;
+    return cmap;
+}   // end create
+
+
+CurvatureMap::Ptr CurvatureMap::update( const CurvatureMap &prev, const r3d::Mesh &pmesh, const r3d::Mesh &mesh,
+                                        const ProgressFn &pfn, const CancelFn &cfn)
+{
+    const std::vector<int> fids = sortedIds( mesh.faces());
+    const std::vector<int> vids = sortedIds( mesh.vtxIds());
+    const size_t nvids = vids.size();
+
+    // Match vertices with the previous mesh by ID first.
+    const IntSet &pvids = pmesh.vtxIds();
+    std::vector<int> vmap( maxId( vids), -1);
+    parallelChunks( nvids, [&]( size_t i0, size_t i1)
+    {
+        for ( size_t i = i0; i < i1; ++i)
+        {
+            const int vidx = vids[i];
+            if ( pvids.count(vidx) > 0 && pmesh.uvtx(vidx) == mesh.uvtx(vidx))
+                vmap[vidx] = vidx;
+        }   // end for
+    });
+
+    // If most vertices weren't matched by ID, the mesh may have been renumbered so match by position.
+    const size_t nmatched = size_t( std::count_if( vids.begin(), vids.end(), [&]( int vidx){ return vmap[vidx] >= 0;}));
+    if ( nmatched < nvids / 2)
+    {
+        std::unordered_map<Vec3f, int, PosHash> pmap;
+        pmap.reserve( pvids.size());
+        for ( int pidx : pvids)
+            pmap[pmesh.uvtx(pidx)] = pidx;
+        parallelChunks( nvids, [&]( size_t i0, size_t i1)
+        {
+            for ( size_t i = i0; i < i1; ++i)
+            {
+                const int vidx = vids[i];
+                if ( vmap[vidx] < 0)
+                {
+                    const auto it = pmap.find( mesh.uvtx(vidx));
+                    if ( it != pmap.end())
+                        vmap[vidx] = it->second;
+                }   // end if
+            }   // end for
+        });
+    }   // end if
+
+    // Match faces having all vertices matched with faces of the previous mesh.
+    std::vector<int> fmap( maxId( fids), -1);
+    parallelChunks( fids.size(), [&]( size_t i0, size_t i1)
+    {
+        for ( size_t i = i0; i < i1; ++i)
+        {
+            const int *fvidxs = mesh.fvidxs( fids[i]);
+            const int p0 = vmap[fvidxs[0]];
+            const int p1 = vmap[fvidxs[1]];
+            const int p2 = vmap[fvidxs[2]];
+            if ( p0 >= 0 && p1 >= 0 && p2 >= 0)
+                fmap[fids[i]] = findFace( pmesh, p0, p1, p2);
+        }   // end for
+    });
+
+    // A vertex must be recomputed if it's unmatched, or if any of its faces are unmatched or were removed.
+    // This covers the edited region and the vertices bordering it.
+    std::vector<char> dirty( vmap.size(), 0);
+    parallelChunks( nvids, [&]( size_t i0, size_t i1)
+    {
+        for ( size_t i = i0; i < i1; ++i)
+        {
+            const int vidx = vids[i];
+            const int pidx = vmap[vidx];
+            const IntSet &vfids = mesh.faces( vidx);
+            bool d = pidx < 0 || vfids.size() != pmesh.faces( pidx).size();
+            for ( auto it = vfids.begin(); !d && it != vfids.end(); ++it)
+                d = fmap[*it] < 0;
+            dirty[vidx] = d;
+        }   // end for
+    });
+
+    std::vector<int> dvids;
+    for ( int vidx : vids)
+        if ( dirty[vidx])
+            dvids.push_back( vidx);
+
+    if ( dvids.size() > nvids / 2)
+        return create( mesh, pfn, cfn);
+
+    Ptr cmap( new CurvatureMap);
+    cmap->_allocate( maxId( fids), maxId( vids));
+    parallelChunks( fids.size(), [&]( size_t i0, size_t i1)
+    {
+        for ( size_t i = i0; i < i1; ++i)
+        {
+            const int fid = fids[i];
+            const int pfid = fmap[fid];
+            if ( pfid < 0)
+                cmap->_setFace( mesh, fid);
+            else
+            {
+                cmap->_fnrms.row(fid) = prev._fnrms.row(pfid);
+                cmap->_fareas[fid] = prev._fareas[pfid];
+            }   // end else
+        }   // end for
+    });
+
+    parallelChunks( nvids, [&]( size_t i0, size_t i1)
+    {
+        for ( size_t i = i0; i < i1; ++i)
+        {
+            const int vidx = vids[i];
+            if ( dirty[vidx])
+                continue;
+            const int pidx = vmap[vidx];
+            cmap->_vnrms.row(vidx) = prev._vnrms.row(pidx);
+            cmap->_pdir1.row(vidx) = prev._pdir1.row(pidx);
+            cmap->_pdir2.row(vidx) = prev._pdir2.row(pidx);
+            cmap->_kp1[vidx] = prev._kp1[pidx];
+            cmap->_kp2[vidx] = prev._kp2[pidx];
+        }   // end for
+    });
+
+    cmap->_ncomputed = dvids.size();
+    CurvatureMap *cm = cmap.get();
+    if ( !processBlocks( dvids, [&]( int vidx){ cm->_setVertexNormal( mesh, vidx);}, pfn, cfn, 0.0f, 0.3f)
+      || !processBlocks( dvids, [&]( int vidx){ cm->_setVertexCurvature( mesh, vidx);}, pfn, cfn, 0.3f, 1.0f))
+        cmap = nullptr;
+    return cmap;
+}   // end update
+
+
+CurvatureMap::CancelFn CurvatureMap::threadInterruptionFn()
+{
+    // Pooled action workers share threads so interruption is requested of the worker not the thread.
+    const Action::FaceActionWorker *worker = Action::FaceActionWorker::current();
+    if ( worker)
+        return worker->cancelToken()->fn();
+    const QThread *thread = QThread::currentThread();
+    return [thread](){ return thread->isInterruptionRequested();};
+}   // end threadInterruptionFn
+
+
+void CurvatureMap::_allocate( int nf, int nv)
+{
+    _fnrms = MatX3f::Zero( nf, 3);
+    _fareas = VecXf::Zero( nf);
+    _vnrms = MatX3f::Zero( nv, 3);
+    _pdir1 = MatX3f::Zero( nv, 3);
+    _pdir2 = MatX3f::Zero( nv, 3);
+    _kp1 = VecXf::Zero( nv);
+    _kp2 = VecXf::Zero( nv);
+}   // end _allocate
+
+
+bool CurvatureMap::_build( const r3d::Mesh &mesh, const ProgressFn &pfn, const CancelFn &cfn)
+{
+    const std::vector<int> fids = sortedIds( mesh.faces());
+    const std::vector<int> vids = sortedIds( mesh.vtxIds());
+    _allocate( maxId( fids), maxId( vids));
+    _ncomputed = vids.size();
+
+    // Each stage only reads data written by the previous stage so blocks within a stage are independent.
+    return processBlocks( fids, [&]( int fid){ _setFace( mesh, fid);}, pfn, cfn, 0.0f, 0.2f)
+        && processBlocks( vids, [&]( int vidx){ _setVertexNormal( mesh, vidx);}, pfn, cfn, 0.2f, 0.3f)
+        && processBlocks( vids, [&]( int vidx){ _setVertexCurvature( mesh, vidx);}, pfn, cfn, 0.3f, 1.0f);
+}   // end _build
+
+
+void CurvatureMap::_setFace( const r3d::Mesh &mesh, int fid)
+{
+    const int *fvidxs = mesh.fvidxs( fid);
+    const Vec3f v0 = mesh.uvtx( fvidxs[0]);
+    const Vec3f c = (mesh.uvtx( fvidxs[1]) - v0).cross( mesh.uvtx( fvidxs[2]) - v0);
+    const float len = c.norm();
+    _fareas[fid] = 0.5f * len;
+    if ( len > 0)
+        _fnrms.row(fid) = (c / len).transpose();
+}   // end _setFace
+
+
+void CurvatureMap::_setVertexNormal( const r3d::Mesh &mesh, int vidx)
+{
+    Vec3f nrm = Vec3f::Zero();
+    for ( int fid : mesh.faces( vidx))
+        nrm += _fareas[fid] * _fnrms.row(fid).transpose();
+    const float len = nrm.norm();
+    if ( len > 0)
+        _vnrms.row(vidx) = (nrm / len).transpose();
+}   // end _setVertexNormal
+
+
+void CurvatureMap::_setVertexCurvature( const r3d::Mesh &mesh, int vidx)
+{
+    const Vec3f nrm = vertexNormal( vidx);
+    if ( nrm.isZero())
+        return;
+
+    // Orthonormal basis (u,w) of the tangent plane
+    const Vec3f u = (fabsf(nrm[0]) < 0.9f ? Vec3f::UnitX() : Vec3f::UnitY()).cross(nrm).normalized();
+    const Vec3f w = nrm.cross(u);
+
+    // Least squares fit of the second fundamental form [e f; f g] to the normal curvatures
+    // along the one-ring edges with each edge weighted by the area of its adjacent faces.
+    const Vec3f v = mesh.uvtx( vidx);
+    Mat3f A = Mat3f::Zero();
+    Vec3f b = Vec3f::Zero();
+    for ( int fid : mesh.faces( vidx))
+    {
+        const int *fvidxs = mesh.fvidxs( fid);
+        const float wt = _fareas[fid];
+        for ( int i = 0; i < 3; ++i)
+        {
+            if ( fvidxs[i] == vidx)
+                continue;
+            const Vec3f d = v - mesh.uvtx( fvidxs[i]);
+            const float sqlen = d.squaredNorm();
+            const float x = d.dot(u);
+            const float y = d.dot(w);
+            const float tsqlen = x*x + y*y;
+            if ( sqlen == 0 || tsqlen == 0)
+                continue;
+            const float k = 2 * nrm.dot(d) / sqlen;    // Normal curvature along the edge
+            const Vec3f c( x*x / tsqlen, 2*x*y / tsqlen, y*y / tsqlen);
+            A += wt * c * c.transpose();
+            b += (wt * k) * c;
+        }   // end for
+    }   // end for
+
+    Eigen::LDLT<Mat3f> ldlt( A);
+    const float tr = A.trace();
+    if ( A.determinant() <= 1e-6f * tr*tr*tr || ldlt.info() != Eigen::Success)
+        return;     // Too few distinct edge directions (e.g. isolated or boundary spike)
+    const Vec3f efg = ldlt.solve( b);
+
+    Eigen::Matrix2f S;
+    S << efg[0], efg[1],
+         efg[1], efg[2];
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix2f> solver( S);   // Ascending eigenvalues
+    const Eigen::Matrix2f &E = solver.eigenvectors();
+    _kp1[vidx] = solver.eigenvalues()[1];
+    _kp2[vidx] = solver.eigenvalues()[0];
+    _pdir1.row(vidx) = (E(0,1) * u + E(1,1) * w).transpose();
+    _pdir2.row(vidx) = (E(0,0) * u + E(1,0) * w).transpose();
+}   // end _setVertexCurvature
@@ -44,25 +44,26 @@ bool FaceFinder2D::find( const cv::Mat_<byte> lightMap)
     bool found = false;
     _faceBox = cv::RotatedRect();
     assert( isInit());
-    if (!FeaturesDetector::find( lightMap))
+    FeaturesDetector::Result fres;
+    if (!FeaturesDetector::detect( lightMap, fres))
         std::cerr << "[WARNING] FaceTools::Detect::FaceFinder2D::find: No face found!" << std::endl;
-    else if ( _findEyes( lightMap))
+    else if ( _findEyes( lightMap, fres))
         found = true;
     return found;
 }   // end find
 
 
-bool FaceFinder2D::_findEyes( const cv::Mat_<byte> lightMap)
+bool FaceFinder2D::_findEyes( const cv::Mat_<byte> lightMap, const FeaturesDetector::Result &fres)
 {
     const cv::Size msz = lightMap.size();
-    cv::Rect faceBox = FeaturesDetector::faceBox();
+    const cv::Rect &faceBox = fres.faceBox;
     assert( faceBox.area() > 0);
 
     // Reset
     _leye = cv::RotatedRect();
     _reye = cv::RotatedRect();
-    cv::Rect leye = FeaturesDetector::leftEye();
-    cv::Rect reye = FeaturesDetector::rightEye();
+    cv::Rect leye = fres.lEyeBox;
+    cv::Rect reye = fres.rEyeBox;
 
     // Eye boxes are detected relative to the face, so add the position of the
     // face box to the eye boxes to get their absolute positions.
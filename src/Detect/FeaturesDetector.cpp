@@ -82,58 +82,122 @@ bool collectDetections( const std::vector<HCD::Ptr>& hcds, std::list<cv::Rect>&
 
 
 // static initialisers
-std::vector<HCD::Ptr> FeaturesDetector::s_faceDetectors;
-std::vector<HCD::Ptr> FeaturesDetector::s_eyeDetectors;
-cv::Rect FeaturesDetector::s_faceBox;
-cv::Rect FeaturesDetector::s_lEyeBox;
-cv::Rect FeaturesDetector::s_rEyeBox;
+std::string FeaturesDetector::s_modelDir;
+std::vector<FeaturesDetector*> FeaturesDetector::s_pool;
+int FeaturesDetector::s_gen(0);
+QMutex FeaturesDetector::s_lock;
 
 
-// static public
-bool FeaturesDetector::initialise( const std::string& pdir)
+// private static
+FeaturesDetector* FeaturesDetector::_create( const std::string& pdir, int gen)
 {
-    s_faceDetectors.clear();
-    s_eyeDetectors.clear();
+    FeaturesDetector *fd = new FeaturesDetector;
+    fd->_gen = gen;
+
+    fd->_faceDetectors.push_back( HCD::create( createPath( pdir, FACE0_MODEL_FILE)));
+    fd->_faceDetectors.push_back( HCD::create( createPath( pdir, FACE1_MODEL_FILE)));
+    fd->_faceDetectors.push_back( HCD::create( createPath( pdir, FACE2_MODEL_FILE)));
+    fd->_faceDetectors.push_back( HCD::create( createPath( pdir, FACE3_MODEL_FILE)));
+
+    fd->_eyeDetectors.push_back( HCD::create( createPath( pdir, EYE0_MODEL_FILE)));
+    fd->_eyeDetectors.push_back( HCD::create( createPath( pdir, EYE1_MODEL_FILE)));
+    fd->_eyeDetectors.push_back( HCD::create( createPath( pdir, EYE2_MODEL_FILE)));
+    fd->_eyeDetectors.push_back( HCD::create( createPath( pdir, EYE3_MODEL_FILE)));
+
+    const auto isNull = []( const HCD::Ptr hcd){ return hcd == nullptr;};
+    if ( std::any_of( fd->_faceDetectors.begin(), fd->_faceDetectors.end(), isNull)
+      || std::any_of( fd->_eyeDetectors.begin(), fd->_eyeDetectors.end(), isNull))
+    {
+        delete fd;
+        fd = nullptr;
+    }   // end if
 
-    s_faceDetectors.push_back( HCD::create( createPath( pdir, FACE0_MODEL_FILE)));
-    s_faceDetectors.push_back( HCD::create( createPath( pdir, FACE1_MODEL_FILE)));
-    s_faceDetectors.push_back( HCD::create( createPath( pdir, FACE2_MODEL_FILE)));
-    s_faceDetectors.push_back( HCD::create( createPath( pdir, FACE3_MODEL_FILE)));
+    return fd;
+}   // end _create
 
-    s_eyeDetectors.push_back( HCD::create( createPath( pdir, EYE0_MODEL_FILE)));
-    s_eyeDetectors.push_back( HCD::create( createPath( pdir, EYE1_MODEL_FILE)));
-    s_eyeDetectors.push_back( HCD::create( createPath( pdir, EYE2_MODEL_FILE)));
-    s_eyeDetectors.push_back( HCD::create( createPath( pdir, EYE3_MODEL_FILE)));
 
-    for ( const HCD::Ptr hcd : s_faceDetectors)
+// private static
+void FeaturesDetector::_release( FeaturesDetector *fd)
+{
+    s_lock.lock();
+    if ( fd->_gen == s_gen)
     {
-        if ( hcd == nullptr)
-        {
-            s_faceDetectors.clear();
-            s_eyeDetectors.clear();
-            return false;
-        }   // end if
-    }   // end for
-
-    for ( const HCD::Ptr hcd : s_eyeDetectors)
+        s_pool.push_back(fd);
+        fd = nullptr;
+    }   // end if
+    s_lock.unlock();
+    delete fd;  // Stale (detector was checked out over a re-initialise)
+}   // end _release
+
+
+// static public
+bool FeaturesDetector::initialise( const std::string& pdir)
+{
+    s_lock.lock();
+    for ( FeaturesDetector *fd : s_pool)
+        delete fd;
+    s_pool.clear();
+    s_modelDir = "";
+    s_gen++;
+
+    FeaturesDetector *fd = _create( pdir, s_gen);
+    if ( fd)
     {
-        if ( hcd == nullptr)
-        {
-            s_faceDetectors.clear();
-            s_eyeDetectors.clear();
-            return false;
-        }   // end if
-    }   // end for
+        s_modelDir = pdir;
+        s_pool.push_back(fd);
+    }   // end if
+    s_lock.unlock();
 
-    return true;
+    return fd != nullptr;
 }   // end initialise
 
 
-// private static
-bool FeaturesDetector::findEyes()
+// static public
+bool FeaturesDetector::isInit()
+{
+    s_lock.lock();
+    const bool isinit = !s_modelDir.empty();
+    s_lock.unlock();
+    return isinit;
+}   // end isInit
+
+
+// static public
+FeaturesDetector::Ptr FeaturesDetector::get()
+{
+    s_lock.lock();
+    FeaturesDetector *fd = nullptr;
+    if ( !s_pool.empty())
+    {
+        fd = s_pool.back();
+        s_pool.pop_back();
+    }   // end if
+    const std::string pdir = s_modelDir;
+    const int gen = s_gen;
+    s_lock.unlock();
+
+    // Load the cascades for a new detector outside of the lock
+    if ( !fd && !pdir.empty())
+        fd = _create( pdir, gen);
+
+    if ( !fd)
+        return nullptr;
+    return Ptr( fd, []( FeaturesDetector *x){ _release(x);});
+}   // end get
+
+
+// static public
+bool FeaturesDetector::detect( const cv::Mat_<byte> img, Result &res)
+{
+    Ptr fd = get();
+    return fd && fd->find( img, res);
+}   // end detect
+
+
+bool FeaturesDetector::_findEyes( Result &res) const
 {
     std::list<cv::Rect> eyes;
-    if ( !collectDetections( s_eyeDetectors, eyes))
+    if ( !collectDetections( _eyeDetectors, eyes))
         return false;
 
     // Get the two largest clusters
@@ -168,22 +232,20 @@ bool FeaturesDetector::findEyes()
         rcp = cv::Point( cvRound(cp0.x), cvRound(cp0.y));
     }   // end if
 
-    s_lEyeBox = cv::Rect( lcp.x - meanBox.width/2, lcp.y - meanBox.height/2, meanBox.width, meanBox.height);
-    s_rEyeBox = cv::Rect( rcp.x - meanBox.width/2, rcp.y - meanBox.height/2, meanBox.width, meanBox.height);
+    res.lEyeBox = cv::Rect( lcp.x - meanBox.width/2, lcp.y - meanBox.height/2, meanBox.width, meanBox.height);
+    res.rEyeBox = cv::Rect( rcp.x - meanBox.width/2, rcp.y - meanBox.height/2, meanBox.width, meanBox.height);
     return true;
-}   // end findEyes
+}   // end _findEyes
 
 
-// public static
-bool FeaturesDetector::find( const cv::Mat_<byte> img)
+bool FeaturesDetector::find( const cv::Mat_<byte> img, Result &res)
 {
+    res = Result();
     const cv::Mat_<byte> dimg = rimg::contrastStretch( img);
-    // Create member instances
-    std::for_each( s_faceDetectors.begin(), s_faceDetectors.end(), [=]( HCD::Ptr hcd){ hcd->setImage(dimg);});
+    std::for_each( _faceDetectors.begin(), _faceDetectors.end(), [=]( HCD::Ptr hcd){ hcd->setImage(dimg);});
 
-    s_faceBox = cv::Rect(0,0,0,0);
     std::list<cv::Rect> faces;
-    if ( !collectDetections( s_faceDetectors, faces))
+    if ( !collectDetections( _faceDetectors, faces))
         return false;
 
     std::vector<RC> clusters;
@@ -196,21 +258,21 @@ bool FeaturesDetector::find( const cv::Mat_<byte> img)
                                                  { return rc0->calcQuality() > rc1->calcQuality();});
 
     const cv::Rect_<double> fb = clusters[0]->getMean();
-    s_faceBox.x = cvRound(fb.x);
-    s_faceBox.y = cvRound(fb.y);
-    s_faceBox.width = cvRound(fb.width);
-    s_faceBox.height = cvRound(fb.height);
+    res.faceBox.x = cvRound(fb.x);
+    res.faceBox.y = cvRound(fb.y);
+    res.faceBox.width = cvRound(fb.width);
+    res.faceBox.height = cvRound(fb.height);
 
     //Set detectors from face box
     // Only use the top 3/5ths of the face box for the eyes
-    cv::Rect topHalf = s_faceBox;
-    topHalf.height = (int)cvRound(3*((double)(s_faceBox.height))/5);
+    cv::Rect topHalf = res.faceBox;
+    topHalf.height = (int)cvRound(3*((double)(res.faceBox.height))/5);
     cv::Mat_<byte> thimg = rimg::contrastStretch( dimg( topHalf));
     cv::medianBlur( thimg, thimg, 5);
-    std::for_each( s_eyeDetectors.begin(), s_eyeDetectors.end(), [=]( HCD::Ptr hcd){ hcd->setImage( thimg);});
+    std::for_each( _eyeDetectors.begin(), _eyeDetectors.end(), [=]( HCD::Ptr hcd){ hcd->setImage( thimg);});
 
-    if ( !checkFaceBox( s_faceBox))
+    if ( !checkFaceBox( res.faceBox))
         return false;
 
-    return findEyes();
+    return _findEyes( res);
 }   // end find
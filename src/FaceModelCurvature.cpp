@@ -19,60 +19,90 @@
 #include <FaceModel.h>
 #include <r3dvis/VtkTools.h>
 #include <vtkPointData.h>
+#include <iostream>
 #include <cassert>
 using FaceTools::FaceModelCurvature;
 using FaceTools::FM;
+using FaceTools::MatX3f;
 
-std::unordered_map<const FM*, r3d::Curvature::Ptr> FaceModelCurvature::_metrics;
-QReadWriteLock FaceModelCurvature::_lock;
+FaceTools::ModelCache<FaceTools::CurvatureMap> FaceModelCurvature::_cache;
+FaceTools::ModelCache<const r3d::Mesh> FaceModelCurvature::_meshes;
 
 
-FaceModelCurvature::RPtr FaceModelCurvature::rmetrics( const FM *fm)
+bool FaceModelCurvature::_isCurrent( const FM *fm)
 {
-    _lock.lockForRead();
+    // The cached mesh is kept alive so no other mesh can share its address
+    std::shared_ptr<const r3d::Mesh> mesh = _meshes.read(fm);
+    return mesh && mesh.get() == &fm->mesh();
+}   // end _isCurrent
 
-    const r3d::Curvature *cm = _metrics.count(fm) > 0 ?  _metrics.at(fm).get() : nullptr;
-    if ( !cm)
-    {
-        _lock.unlock();
-        return nullptr;
-    }   // end if
 
-    return RPtr( cm, []( const r3d::Curvature*){ _lock.unlock();});
-}   // end rmetrics
+FaceModelCurvature::RPtr FaceModelCurvature::rmetrics( const FM *fm) { return _isCurrent(fm) ? _cache.read(fm) : nullptr;}
+
 
+FaceModelCurvature::WPtr FaceModelCurvature::wmetrics( const FM *fm) { return _isCurrent(fm) ? _cache.write(fm) : nullptr;}
 
-FaceModelCurvature::WPtr FaceModelCurvature::wmetrics( const FM *fm)
+
+void FaceModelCurvature::purge( const FM *fm)
 {
-    _lock.lockForWrite();
+    _cache.purge(fm);
+    _meshes.purge(fm);
+}   // end purge
+
 
-    r3d::Curvature *cm = _metrics.count(fm) > 0 ?  _metrics.at(fm).get() : nullptr;
-    if ( !cm)
+bool FaceModelCurvature::add( const FM *fm, const CurvatureMap::ProgressFn &pfn, const CurvatureMap::CancelFn &cfn)
+{
+    CurvatureMap::Ptr cmap = CurvatureMap::create( fm->mesh(), pfn, cfn);    // Blocks
+    if ( !cmap)
+        return false;
+    assert( !_cache.has(fm));
+    _cache.set( fm, cmap);  // Not visible to clients until the mesh is set
+    _meshes.set( fm, fm->meshPtr());
+    return true;
+}   // end add
+
+
+bool FaceModelCurvature::update( const FM *fm, const CurvatureMap::ProgressFn &pfn, const CurvatureMap::CancelFn &cfn)
+{
+    std::shared_ptr<const r3d::Mesh> pmesh = _meshes.read(fm);
+    RPtr pcmap = _cache.read(fm);
+    if ( !pmesh || !pcmap)
     {
-        _lock.unlock();
-        return nullptr;
+        pmesh = nullptr;
+        pcmap = nullptr;
+        purge( fm);
+        return add( fm, pfn, cfn);
     }   // end if
 
-    return WPtr( cm, []( r3d::Curvature*){ _lock.unlock(); });
-}   // end wmetrics
+    if ( pmesh.get() == &fm->mesh())
+        return true;
 
+    CurvatureMap::Ptr cmap = CurvatureMap::update( *pcmap, *pmesh, fm->mesh(), pfn, cfn);
+    pmesh = nullptr;
+    pcmap = nullptr;
+    if ( !cmap)
+        return false;
 
-void FaceModelCurvature::purge( const FM *fm)
-{
-    _lock.lockForWrite();
-    _metrics.erase(fm);
-    _lock.unlock();
-}   // end purge
+#ifndef NDEBUG
+    std::cerr << "[INFO] FaceTools::FaceModelCurvature::update: Recomputed "
+              << cmap->numComputed() << " of " << fm->mesh().numVtxs() << " vertices" << std::endl;
+#endif
+    _cache.set( fm, cmap);
+    _meshes.set( fm, fm->meshPtr());
+    return true;
+}   // end update
 
 
-void FaceModelCurvature::add( const FM *fm)
+vtkSmartPointer<vtkFloatArray> FaceTools::makeNormals( const CurvatureMap &cmap)
 {
-    r3d::Curvature::Ptr cmap = r3d::Curvature::create( fm->mesh());  // Blocks
-    _lock.lockForWrite();
-    assert( _metrics.count(fm) == 0);
-    _metrics[fm] = cmap;
-    _lock.unlock();
-}   // end add
+    const MatX3f &vnrms = cmap.vertexNormals();
+    vtkSmartPointer<vtkFloatArray> nrms = vtkSmartPointer<vtkFloatArray>::New();
+    nrms->SetNumberOfComponents(3);
+    nrms->SetNumberOfTuples( vnrms.rows());
+    for ( int i = 0; i < int(vnrms.rows()); ++i)
+        nrms->SetTuple3( i, vnrms(i,0), vnrms(i,1), vnrms(i,2));
+    return nrms;
+}   // end makeNormals
 
 
 vtkSmartPointer<vtkFloatArray> FaceTools::setNormals( vtkActor *actor, const FM *fm)
@@ -81,7 +111,7 @@ vtkSmartPointer<vtkFloatArray> FaceTools::setNormals( vtkActor *actor, const FM
     FaceModelCurvature::RPtr cmap = FaceModelCurvature::rmetrics( fm);  // May be null if not yet processed curvature
     if ( cmap)
     {
-        nrms = r3dvis::makeNormals( *cmap);
+        nrms = makeNormals( *cmap);
         nrms->SetName("Normals");
         vtkPolyData *pd = r3dvis::getPolyData( actor);
         pd->GetPointData()->SetNormals( nrms);
@@ -17,76 +17,69 @@
 
 #include <FaceTools/FaceModelSymmetry.h>
 #include <FaceTools/MaskRegistration.h>
+#include <FaceTools/MiscFunctions.h>
 #include <FaceTools/FaceModel.h>
 #include <r3d/SurfacePointFinder.h>
+#include <algorithm>
+#include <cmath>
 #include <cassert>
 using FaceTools::FaceModelSymmetry;
+using FaceTools::MaskRegistration;
+using FaceTools::Vec3f;
+using FaceTools::Vec4f;
+using FaceTools::Mat4f;
 using FaceTools::FM;
 
 
-std::unordered_map<const FM*, FaceModelSymmetry::VtxAsymmMap> FaceModelSymmetry::_vtxSymm;
-QReadWriteLock FaceModelSymmetry::_lock;
+FaceTools::ModelCache<FaceModelSymmetry::VtxAsymm> FaceModelSymmetry::_cache;
 
 
-FaceModelSymmetry::RPtr FaceModelSymmetry::vals( const FM *fm)
+FaceModelSymmetry::VtxAsymm::VtxAsymm( size_t n)
 {
-    _lock.lockForRead();
-    const VtxAsymmMap *vvals = _vtxSymm.count(fm) > 0 ? &_vtxSymm.at(fm) : nullptr;
-    if ( !vvals)
-    {
-        _lock.unlock();
-        return nullptr;
-    }   // end if
-    return RPtr( vvals, []( const VtxAsymmMap*){ _lock.unlock();});
-}   // end vals
+    for ( int i = 0; i < 4; ++i)
+        _v[i].resize( n, 0.0f);
+    _has.resize( n, 0);
+}   // end ctor
 
 
-void FaceModelSymmetry::purge( const FM *fm)
-{
-    _lock.lockForWrite();
-    _vtxSymm.erase(fm);
-    _lock.unlock();
-}   // end purge
+FaceModelSymmetry::RPtr FaceModelSymmetry::vals( const FM *fm) { return _cache.read(fm);}
 
 
-void FaceModelSymmetry::add( const FM *fm)
-{
-    assert( _vtxSymm.count(fm) == 0);
-    _lock.lockForWrite();
+void FaceModelSymmetry::purge( const FM *fm) { _cache.purge(fm);}
 
-    const r3d::Mesh &mesh = fm->mesh();
-    const r3d::Mesh &mask = fm->mask();
-    const r3d::KDTree &mkdt = fm->maskKDTree();
 
-    const r3d::SurfacePointFinder maskPointFinder( mask);
-    const std::unordered_map<int,int>& maskOppVtxs = MaskRegistration::maskData()->oppVtxs;
+namespace {
 
-    Vec3f m = Vec3f::Zero();
-    Vec3f u(1,0,0);
-    if ( fm->hasLandmarks())
+struct SymmetryCalculator
+{
+    SymmetryCalculator( const FM *fm, const std::vector<int> &oppVtxs)
+        : mask( fm->mask()), mkdt( fm->maskKDTree()), maskPointFinder( fm->mask()),
+          opp( oppVtxs), m( Vec3f::Zero()), u( 1,0,0)
     {
-        const Mat4f T = fm->transformMatrix();
-        u = T.block<3,1>(0,0);
-        m = T.block<3,1>(0,3);
-    }   // end if
+        if ( fm->hasLandmarks())
+        {
+            const Mat4f T = fm->transformMatrix();
+            u = T.block<3,1>(0,0);
+            m = T.block<3,1>(0,3);
+        }   // end if
+    }   // end ctor
 
-    VtxAsymmMap &vmap = _vtxSymm[fm];
-    for ( int vidx : mesh.vtxIds())
+    // Find pm as the position on the mask closest to original vertex p on the model, and qm as
+    // its anthropometrically mapped partner on the other side of the face. Returns false (leaving
+    // qm unset) if pm lies on a mask vertex that has no opposite vertex in the lookup.
+    bool map( const Vec3f &p, Vec3f &pm, Vec3f &qm) const
     {
-        const Vec3f &p = mesh.vtx(vidx);    // Original vertex on the model
-
-        // Find pm as the position on the mask that vertex p is closest to and mt as the triangle it's within:
-        Vec3f pm;
         int mt = -1;
         int pvidx = mkdt.find( p);
         maskPointFinder.find( p, pvidx, mt, pm);
-        Vec3f qm;
 
         if ( mt < 0)
         {
             assert( pvidx >= 0);
             assert( pm == mask.vtx(pvidx));
-            qm = mask.vtx(maskOppVtxs.at(pvidx));
+            if ( opp[pvidx] < 0)
+                return false;
+            qm = mask.vtx(opp[pvidx]);
         }   // end if
         else
         {
@@ -97,32 +90,126 @@ void FaceModelSymmetry::add( const FM *fm)
             // in the opposite polygon will not match due to the surface being reflected, but
             // the normal still pointing out from the face.
             const int *fvidxs = mask.fvidxs(mt);
-            const int v0 = maskOppVtxs.at(fvidxs[0]);
-            const int v1 = maskOppVtxs.at(fvidxs[1]);
-            const int v2 = maskOppVtxs.at(fvidxs[2]);
+            const int v0 = opp[fvidxs[0]];
+            const int v1 = opp[fvidxs[1]];
+            const int v2 = opp[fvidxs[2]];
+            if ( v0 < 0 || v1 < 0 || v2 < 0)
+                return false;
             qm = bm[0]*mask.vtx(v0) + bm[1]*mask.vtx(v1) + bm[2]*mask.vtx(v2);
         }   // end else
+        return true;
+    }   // end map
+
+    // Calculate the asymmetry values for n mapped positions pm and their partners qm given as
+    // separate coordinate arrays. Branch free over contiguous arrays so the compiler vectorises it.
+    void asymmetry( size_t n, const float *pmx, const float *pmy, const float *pmz,
+                              const float *qmx, const float *qmy, const float *qmz,
+                              float *ax, float *ay, float *az, float *al) const
+    {
+        const float mx = m[0], my = m[1], mz = m[2];
+        const float ux = u[0], uy = u[1], uz = u[2];
+        for ( size_t j = 0; j < n; ++j)
+        {
+            // Find pmr as pm reflected through the medial plane to its perfectly symmetric position:
+            const float d = 2*((mx - pmx[j])*ux + (my - pmy[j])*uy + (mz - pmz[j])*uz);
+            const float pmrx = pmx[j] + d*ux;
+            const float pmry = pmy[j] + d*uy;
+            const float pmrz = pmz[j] + d*uz;
+
+            const float pm2qmx = qmx[j] - pmx[j];
+            const float pm2qmy = qmy[j] - pmy[j];
+            const float pm2qmz = qmz[j] - pmz[j];
+            const float pmr2qmx = qmx[j] - pmrx;
+            const float pmr2qmy = qmy[j] - pmry;
+            const float pmr2qmz = qmz[j] - pmrz;
+            const float pm2pmrx = pmrx - pmx[j];
+            const float pm2pmry = pmry - pmy[j];
+            const float pm2pmrz = pmrz - pmz[j];
+
+            ax[j] = fabsf(pm2pmrx) - fabsf(pm2qmx);   // Asymmetry through medial plane (along X-axis)
+            ay[j] = -pmr2qmy;  // Asymmetry along Y-axis
+            az[j] = -pmr2qmz;  // Asymmetry along Z-axis
+
+            // Get the sign of the difference by comparing the distance of qm from pm with the distance of pmr from pm.
+            // If (qm - pm) is greater, that means that the original masked mapped point pm with respect to its
+            // anthropometrically mapped partner is closer in than expected.
+            const float sqd0 = pm2qmx*pm2qmx + pm2qmy*pm2qmy + pm2qmz*pm2qmz;
+            const float sqd1 = pm2pmrx*pm2pmrx + pm2pmry*pm2pmry + pm2pmrz*pm2pmrz;
+            const float sgn = sqd0 >= sqd1 ? -1.0f : 1.0f;
+            // Find the magnitude of difference of the anthropometrically mapped symmetric point (qm)
+            // with the expected perfectly laterally symmetric point pmr and multiply this by the sign above.
+            al[j] = sgn * sqrtf( pmr2qmx*pmr2qmx + pmr2qmy*pmr2qmy + pmr2qmz*pmr2qmz);   // Signed disparity
+        }   // end for
+    }   // end asymmetry
+
+    const r3d::Mesh &mask;
+    const r3d::KDTree &mkdt;
+    const r3d::SurfacePointFinder maskPointFinder;
+    const std::vector<int> &opp;
+    Vec3f m, u;
+};  // end struct
+
+
+// Returns the mask data's dense lookup of opposite vertices indexed by mask vertex ID, or the
+// lookup copied into padded if the given mask has more vertices than the loaded mask (in
+// which case the extra vertices have no opposite and are given -1).
+const std::vector<int>& denseOppositeVertices( const MaskRegistration::MaskData &mdata,
+                                               const r3d::Mesh &mask, std::vector<int> &padded)
+{
+    if ( mdata.opposite.size() >= size_t(mask.numVtxs()))
+        return mdata.opposite;
+    padded = mdata.opposite;
+    padded.resize( mask.numVtxs(), -1);
+    return padded;
+}   // end denseOppositeVertices
 
-        // Find pr as original point p reflected through the medial plane to its perfectly symmetric position:
-        const Vec3f pmr = pm + 2*(m-pm).dot(u)*u;
+}   // end namespace
 
-        const Vec3f pm2qm = qm - pm;
-        const Vec3f pmr2qm = qm - pmr;
-        const Vec3f pm2pmr = pmr - pm;
 
-        Vec4f &vals = vmap[vidx];
-        vals[0] = fabsf(pm2pmr[0]) - fabsf(pm2qm[0]);    // Asymmetry through medial plane (along X-axis)
-        vals[1] = -pmr2qm[1];  // Asymmetry along Y-axis
-        vals[2] = -pmr2qm[2];  // Asymmetry along Z-axis
+void FaceModelSymmetry::add( const FM *fm)
+{
+    const r3d::Mesh &mesh = fm->mesh();
+    const auto &vidset = mesh.vtxIds();
+    const std::vector<int> vids( vidset.begin(), vidset.end());
+    const size_t N = vids.size();
 
-        // Get the sign of the difference by comparing the distance of qm from pm with the distance of pmr from pm.
-        // If (qm - pm) is greater, that means that the original masked mapped point pm with respect to its
-        // anthropometrically mapped partner is closer in than expected.
-        const float sgn = pm2qm.squaredNorm() >= pm2pmr.squaredNorm() ? -1 : 1;
-        // Find the magnitude of difference of the anthropometrically mapped symmetric point (qm)
-        // with the expected perfectly laterally symmetric point pmr and multiply this by the sign above.
-        vals[3] = sgn * pmr2qm.norm();    // Signed disparity of surface to reflected point
-    }   // end for
+    const MaskRegistration::MaskPtr mdata = MaskRegistration::maskData();   // Keeps the lookup alive
+    std::vector<int> padded;
+    const std::vector<int> &opp = denseOppositeVertices( *mdata, fm->mask(), padded);
+    const SymmetryCalculator calc( fm, opp);
 
-    _lock.unlock();
+    const int maxId = N > 0 ? *std::max_element( vids.begin(), vids.end()) : -1;
+
+    // Each chunk writes only to its own set of vertex entries of this local buffer so no locking is needed.
+    std::shared_ptr<VtxAsymm> vasymm( new VtxAsymm( size_t(maxId + 1)));
+    parallelChunks( N, [&]( size_t i0, size_t i1)
+    {
+        // First map the chunk's vertices to the mask (tree searches) storing the results as
+        // separate coordinate arrays, then calculate the asymmetry over those arrays in one pass.
+        const size_t n = i1 - i0;
+        std::vector<float> buf( 10*n);
+        float *pm[3] = { &buf[0], &buf[n], &buf[2*n]};
+        float *qm[3] = { &buf[3*n], &buf[4*n], &buf[5*n]};
+        float *av[4] = { &buf[6*n], &buf[7*n], &buf[8*n], &buf[9*n]};
+
+        Vec3f p, q;
+        for ( size_t j = 0; j < n; ++j)
+        {
+            if ( !calc.map( mesh.vtx( vids[i0+j]), p, q))
+                q = Vec3f::Constant( NAN);   // No partner so all values become NaN
+            for ( int c = 0; c < 3; ++c)
+            {
+                pm[c][j] = p[c];
+                qm[c][j] = q[c];
+            }   // end for
+        }   // end for
+
+        calc.asymmetry( n, pm[0], pm[1], pm[2], qm[0], qm[1], qm[2], av[0], av[1], av[2], av[3]);
+
+        for ( size_t j = 0; j < n; ++j)
+            vasymm->set( vids[i0+j], Vec4f( av[0][j], av[1][j], av[2][j], av[3][j]));
+    });
+
+    _cache.set( fm, vasymm);   // Only locks to publish
 }   // end add
+
@@ -0,0 +1,481 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <FileIO/FaceModelBinaryFileHandler.h>
+#include <FileIO/FaceModelXMLFileHandler.h>
+#include <MaskRegistration.h>
+#include <FaceModel.h>
+#include <QFile>
+#include <boost/property_tree/xml_parser.hpp>
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+#include <ctime>
+using FaceTools::FileIO::FaceModelBinaryFileHandler;
+using FaceTools::FM;
+using FaceTools::Vec2f;
+using FaceTools::Vec3f;
+
+
+namespace {
+
+static const char MAGIC[8] = {'3','D','F','B','I','N','\0','\0'};
+static const uint64_t ALIGN = 16;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t nsections;
+    uint32_t byteOrder; // BYTE_ORDER_MARK as written by the host
+    uint32_t pad;
+};  // end struct
+
+struct SectionEntry
+{
+    uint32_t type;
+    uint32_t count;     // Number of elements (vertices, faces, landmarks etc)
+    uint64_t offset;    // From start of file
+    uint64_t size;      // Bytes
+};  // end struct
+
+struct TextureHeader
+{
+    int32_t rows;
+    int32_t cols;
+    int32_t type;
+    int32_t pad;
+};  // end struct
+
+struct LandmarkRecord
+{
+    int32_t aid;
+    int32_t lmid;
+    int32_t side;
+    float pos[3];
+};  // end struct
+
+
+uint64_t aligned( uint64_t n) { return (n + ALIGN - 1) / ALIGN * ALIGN;}
+
+
+// A section to write out where the data are owned by the caller.
+struct OutSection
+{
+    uint32_t type;
+    uint32_t count;
+    std::vector<const char*> data;  // Chunks written contiguously
+    std::vector<uint64_t> sizes;
+    uint64_t size() const { uint64_t n = 0; for ( uint64_t s : sizes) n += s; return n;}
+    void add( const void *d, uint64_t n) { data.push_back( static_cast<const char*>(d)); sizes.push_back(n);}
+};  // end struct
+
+
+// Write out the vertices (transformed as for 3DF) and faces of the given mesh with vertex IDs
+// packed into sequential indices.
+void packMesh( const r3d::Mesh &mesh, std::vector<float> &vtxs, std::vector<int32_t> &faces, std::vector<int> &fids)
+{
+    std::vector<int> vids( mesh.vtxIds().begin(), mesh.vtxIds().end());
+    std::sort( vids.begin(), vids.end());
+    std::vector<int32_t> vmap( vids.empty() ? 0 : size_t(vids.back() + 1), -1);
+    vtxs.resize( 3*vids.size());
+    for ( size_t i = 0; i < vids.size(); ++i)
+    {
+        vmap[size_t(vids[i])] = int32_t(i);
+        const Vec3f &v = mesh.vtx( vids[i]);
+        vtxs[3*i+0] = v[0];
+        vtxs[3*i+1] = v[1];
+        vtxs[3*i+2] = v[2];
+    }   // end for
+
+    fids.assign( mesh.faces().begin(), mesh.faces().end());
+    std::sort( fids.begin(), fids.end());
+    faces.resize( 3*fids.size());
+    for ( size_t i = 0; i < fids.size(); ++i)
+    {
+        const int *fvidxs = mesh.fvidxs( fids[i]);
+        for ( int j = 0; j < 3; ++j)
+            faces[3*i+size_t(j)] = vmap[size_t(fvidxs[j])];
+    }   // end for
+}   // end packMesh
+
+
+std::string makeMetaData( const FM *fm)
+{
+    PTree tree;
+    PTree& topNode = tree.put( "faces","");
+    topNode.put( "<xmlattr>.version", FaceTools::FileIO::XML_VERSION.toStdString());
+    std::ostringstream desc;
+    desc << FaceTools::FileIO::BIN_FILE_DESCRIPTION.toStdString() << ";" << time(nullptr);
+    topNode.put( "description", desc.str());
+    PTree& records = topNode.put( "FaceModels","");
+    records.put( "<xmlattr>.count", 1);
+    FaceTools::FileIO::exportMetaData( fm, false/*no extra data*/, records);
+    std::ostringstream oss;
+    boost::property_tree::write_xml( oss, tree);
+    return oss.str();
+}   // end makeMetaData
+
+
+// Sections of a memory mapped file.
+class MappedSections
+{
+public:
+    // Returns a non-empty error string if the table couldn't be read.
+    QString read( const uchar *data, qint64 fsize)
+    {
+        if ( fsize < qint64(sizeof(Header)))
+            return "File too small!";
+        Header hdr;
+        memcpy( &hdr, data, sizeof(Header));
+        if ( memcmp( hdr.magic, MAGIC, sizeof(MAGIC)) != 0)
+            return "Not a binary face model file!";
+        if ( hdr.version > FaceModelBinaryFileHandler::VERSION)
+            return "File version is more recent than this library allows!";
+        if ( hdr.version < FaceModelBinaryFileHandler::VERSION)
+            return "File version predates the byte order mark; regenerate it from the 3DF!";
+        if ( hdr.byteOrder != BYTE_ORDER_MARK)
+            return "File byte order differs from this machine!";
+        const uint64_t tend = sizeof(Header) + uint64_t(hdr.nsections) * sizeof(SectionEntry);
+        if ( tend > uint64_t(fsize))
+            return "Section table is truncated!";
+        const SectionEntry *stab = reinterpret_cast<const SectionEntry*>( data + sizeof(Header));
+        for ( uint32_t i = 0; i < hdr.nsections; ++i)
+        {
+            // Written so that corrupt offsets and sizes can't wrap around
+            if ( stab[i].offset > uint64_t(fsize) || stab[i].size > uint64_t(fsize) - stab[i].offset)
+                return "Section data are truncated!";
+            // Sections are read in place so must be aligned (the mapping itself is page aligned)
+            if ( stab[i].offset % ALIGN != 0)
+                return "Section data are misaligned!";
+            _sections[stab[i].type] = stab[i];
+        }   // end for
+        _data = data;
+        return "";
+    }   // end read
+
+    bool has( uint32_t type) const { return _sections.count(type) > 0;}
+    uint32_t count( uint32_t type) const { return has(type) ? _sections.at(type).count : 0;}
+    uint64_t size( uint32_t type) const { return has(type) ? _sections.at(type).size : 0;}
+
+    // Returns the start of the given section only if it holds at least n elements of type T.
+    template <typename T>
+    const T* get( uint32_t type, uint64_t n) const
+    {
+        if ( size(type) < n * sizeof(T))
+            return nullptr;
+        return has(type) ? reinterpret_cast<const T*>( _data + _sections.at(type).offset) : nullptr;
+    }   // end get
+
+private:
+    const uchar *_data;
+    std::unordered_map<uint32_t, SectionEntry> _sections;
+};  // end class
+
+
+r3d::Mesh::Ptr makeMesh( const MappedSections &ms, uint32_t vsec, uint32_t fsec, std::vector<int> *fids=nullptr)
+{
+    const uint32_t nv = ms.count( vsec);
+    const uint32_t nf = ms.count( fsec);
+    const float *vtxs = ms.get<float>( vsec, 3*uint64_t(nv));
+    const int32_t *faces = ms.get<int32_t>( fsec, 3*uint64_t(nf));
+    if ( !vtxs || !faces)
+        return nullptr;
+
+    r3d::Mesh::Ptr mesh = r3d::Mesh::create();
+    std::vector<int> vmap( nv);
+    for ( uint32_t i = 0; i < nv; ++i)
+        vmap[i] = mesh->addVertex( Vec3f( vtxs[3*i], vtxs[3*i+1], vtxs[3*i+2]));
+
+    if ( fids)
+        fids->resize( nf, -1);
+    for ( uint32_t i = 0; i < nf; ++i)
+    {
+        const int32_t *f = &faces[3*i];
+        if ( uint32_t(f[0]) >= nv || uint32_t(f[1]) >= nv || uint32_t(f[2]) >= nv)
+            return nullptr;
+        const int fid = mesh->addFace( vmap[f[0]], vmap[f[1]], vmap[f[2]]);
+        if ( fids)
+            (*fids)[i] = fid;
+    }   // end for
+    return mesh;
+}   // end makeMesh
+
+
+void addTexture( const MappedSections &ms, r3d::Mesh &mesh, const std::vector<int> &fids)
+{
+    const TextureHeader *th = ms.get<TextureHeader>( FaceModelBinaryFileHandler::TEXTURE, 1);
+    const float *uvs = ms.get<float>( FaceModelBinaryFileHandler::UVS, 6*uint64_t(fids.size()));
+    if ( !th || !uvs || ms.count( FaceModelBinaryFileHandler::UVS) != fids.size())
+        return;
+    if ( th->rows <= 0 || th->cols <= 0)
+        return;
+
+    // Check the pixel data are all present before wrapping them
+    const uint64_t esize = uint64_t(CV_ELEM_SIZE( th->type));
+    const uint64_t npx = uint64_t(th->rows) * uint64_t(th->cols);
+    if ( ms.size( FaceModelBinaryFileHandler::TEXTURE) < sizeof(TextureHeader) + npx * esize)
+        return;
+    const cv::Mat img( th->rows, th->cols, th->type, const_cast<TextureHeader*>(th) + 1);
+    const int mid = mesh.addMaterial( img.clone());    // Clone since the mapping is released after reading
+    for ( size_t i = 0; i < fids.size(); ++i)
+    {
+        if ( fids[i] < 0)
+            continue;
+        const float *fuvs = &uvs[6*i];
+        mesh.setOrderedFaceUVs( mid, fids[i], Vec2f( fuvs[0], fuvs[1]), Vec2f( fuvs[2], fuvs[3]), Vec2f( fuvs[4], fuvs[5]));
+    }   // end for
+}   // end addTexture
+
+
+void setLandmarks( const MappedSections &ms, FM &fm)
+{
+    const uint32_t n = ms.count( FaceModelBinaryFileHandler::LANDMARKS);
+    const LandmarkRecord *lmks = ms.get<LandmarkRecord>( FaceModelBinaryFileHandler::LANDMARKS, n);
+    if ( !lmks)
+        return;
+    const FaceTools::IntSet aids = fm.assessmentIds();
+    for ( uint32_t i = 0; i < n; ++i)
+    {
+        const LandmarkRecord &r = lmks[i];
+        if ( aids.count(r.aid) > 0)
+            fm.assessment( r.aid)->landmarks().set( r.lmid, Vec3f( r.pos[0], r.pos[1], r.pos[2]), FaceTools::FaceSide(r.side));
+    }   // end for
+}   // end setLandmarks
+
+}   // end namespace
+
+
+bool FaceModelBinaryFileHandler::write( const FM* fm, const QString& fname)
+{
+    assert(fm);
+    QString &err = _err.localData();   // Error for the calling thread
+    err = "";
+
+    try
+    {
+        std::vector<OutSection> sections;
+
+        // Model geometry
+        const r3d::Mesh &mesh = fm->mesh();
+        std::vector<float> vtxs;
+        std::vector<int32_t> faces;
+        std::vector<int> fids;
+        packMesh( mesh, vtxs, faces, fids);
+        sections.push_back( {VERTICES, uint32_t(vtxs.size()/3), {}, {}});
+        sections.back().add( vtxs.data(), vtxs.size() * sizeof(float));
+        sections.push_back( {FACES, uint32_t(fids.size()), {}, {}});
+        sections.back().add( faces.data(), faces.size() * sizeof(int32_t));
+
+        // Texture (models have at most one material)
+        std::vector<float> uvs;
+        TextureHeader th;
+        cv::Mat tex;
+        if ( mesh.hasMaterials())
+        {
+            uvs.resize( 6*fids.size());
+            for ( size_t i = 0; i < fids.size(); ++i)
+            {
+                for ( int j = 0; j < 3; ++j)
+                {
+                    const Vec2f &uv = mesh.faceUV( fids[i], j);
+                    uvs[6*i+size_t(2*j)] = uv[0];
+                    uvs[6*i+size_t(2*j+1)] = uv[1];
+                }   // end for
+            }   // end for
+            sections.push_back( {UVS, uint32_t(fids.size()), {}, {}});
+            sections.back().add( uvs.data(), uvs.size() * sizeof(float));
+
+            tex = mesh.texture( *mesh.materialIds().begin());
+            if ( !tex.isContinuous())
+                tex = tex.clone();
+            th = {tex.rows, tex.cols, tex.type(), 0};
+            sections.push_back( {TEXTURE, 1, {}, {}});
+            sections.back().add( &th, sizeof(TextureHeader));
+            sections.back().add( tex.data, tex.total() * tex.elemSize());
+        }   // end if
+
+        // Mask
+        std::vector<float> mvtxs;
+        std::vector<int32_t> mfaces;
+        std::vector<int> mfids;
+        if ( fm->hasMask())
+        {
+            packMesh( fm->mask(), mvtxs, mfaces, mfids);
+            sections.push_back( {MASK_VERTICES, uint32_t(mvtxs.size()/3), {}, {}});
+            sections.back().add( mvtxs.data(), mvtxs.size() * sizeof(float));
+            sections.push_back( {MASK_FACES, uint32_t(mfids.size()), {}, {}});
+            sections.back().add( mfaces.data(), mfaces.size() * sizeof(int32_t));
+        }   // end if
+
+        // Landmarks for all assessments
+        std::vector<LandmarkRecord> lmks;
+        for ( int aid : fm->assessmentIds())
+        {
+            const Landmark::LandmarkSet &lset = fm->assessment( aid)->landmarks();
+            for ( FaceSide side : {MID, LEFT, RIGHT})
+            {
+                for ( const auto &p : lset.lateral( side))
+                    lmks.push_back( {aid, p.first, int32_t(side), {p.second[0], p.second[1], p.second[2]}});
+            }   // end for
+        }   // end for
+        sections.push_back( {LANDMARKS, uint32_t(lmks.size()), {}, {}});
+        sections.back().add( lmks.data(), lmks.size() * sizeof(LandmarkRecord));
+
+        // Metadata
+        const std::string meta = makeMetaData( fm);
+        sections.push_back( {METADATA, uint32_t(meta.size()), {}, {}});
+        sections.back().add( meta.data(), meta.size());
+
+        // Lay out the section table with aligned offsets
+        Header hdr;
+        memcpy( hdr.magic, MAGIC, sizeof(MAGIC));
+        hdr.version = VERSION;
+        hdr.nsections = uint32_t(sections.size());
+        hdr.byteOrder = BYTE_ORDER_MARK;
+        hdr.pad = 0;
+        std::vector<SectionEntry> stab( sections.size());
+        uint64_t offset = aligned( sizeof(Header) + stab.size() * sizeof(SectionEntry));
+        for ( size_t i = 0; i < sections.size(); ++i)
+        {
+            stab[i] = {sections[i].type, sections[i].count, offset, sections[i].size()};
+            offset = aligned( offset + stab[i].size);
+        }   // end for
+
+        QFile file( fname);
+        if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            err = "Cannot open file for writing!";
+            return false;
+        }   // end if
+
+        static const char ZEROS[ALIGN] = {0};
+        bool ok = file.write( reinterpret_cast<const char*>(&hdr), sizeof(Header)) == qint64(sizeof(Header))
+               && file.write( reinterpret_cast<const char*>(stab.data()), qint64(stab.size() * sizeof(SectionEntry))) == qint64(stab.size() * sizeof(SectionEntry));
+        for ( size_t i = 0; ok && i < sections.size(); ++i)
+        {
+            const qint64 pad = qint64(stab[i].offset) - file.pos();
+            ok = file.write( ZEROS, pad) == pad;
+            for ( size_t j = 0; ok && j < sections[i].data.size(); ++j)
+                ok = file.write( sections[i].data[j], qint64(sections[i].sizes[j])) == qint64(sections[i].sizes[j]);
+        }   // end for
+        file.close();
+
+        if ( !ok)
+            err = "Failed to write binary model data!";
+    }   // end try
+    catch ( const std::exception& e)
+    {
+        std::cerr << "[EXCEPTION] FaceTools::FileIO::FaceModelBinaryFileHandler::write: Failed to write to " << fname.toStdString() << std::endl;
+        err = e.what();
+    }   // end catch
+
+    return err.isEmpty();
+}   // end write
+
+
+FM* FaceModelBinaryFileHandler::read( const QString& fname)
+{
+    QString &err = _err.localData();   // Error for the calling thread
+    err = "";
+    double &fversion = _fversion.localData();
+    fversion = 0.0;
+
+    QFile file( fname);
+    if ( !file.open( QIODevice::ReadOnly))
+    {
+        err = "Unable to open file for reading!";
+        return nullptr;
+    }   // end if
+
+    const qint64 fsize = file.size();
+    uchar *data = file.map( 0, fsize);
+    if ( !data)
+    {
+        err = "Unable to memory map file!";
+        return nullptr;
+    }   // end if
+
+    MappedSections ms;
+    err = ms.read( data, fsize);
+    if ( err.isEmpty() && (!ms.has( VERTICES) || !ms.has( FACES) || !ms.has( METADATA)))
+        err = "Required sections missing from file!";
+
+    FM *fm = nullptr;
+    if ( err.isEmpty())
+    {
+        fm = new FM;
+        try
+        {
+            PTree tree;
+            std::istringstream iss( std::string( ms.get<char>( METADATA, ms.size( METADATA)), ms.size( METADATA)));
+            boost::property_tree::read_xml( iss, tree);
+            if ( !importMetaData( *fm, tree, fversion))
+                err = QObject::tr("No FaceModel objects recorded in file!");
+            else if ( fversion > XML_VERSION.toDouble())
+                err = QObject::tr("File version is more recent than this library allows!");
+        }   // end try
+        catch ( const std::exception&)
+        {
+            err = "Unable to read metadata!";
+        }   // end catch
+
+        if ( err.isEmpty())
+        {
+            setLandmarks( ms, *fm);    // Exact positions (rather than from text)
+
+            std::vector<int> fids;
+            r3d::Mesh::Ptr mesh = makeMesh( ms, VERTICES, FACES, &fids);
+            if ( mesh)
+            {
+                addTexture( ms, *mesh, fids);
+                fm->update( mesh, true, false/*don't resettle landmarks (or update paths) just read in*/);
+                for ( int aid : fm->assessmentIds()) // Do want to update paths over the mesh though
+                    fm->assessment(aid)->paths().update( fm);
+            }   // end if
+            else
+                err = "Couldn't load main mesh!";
+        }   // end if
+
+        if ( err.isEmpty() && ms.has( MASK_VERTICES))
+        {
+            r3d::Mesh::Ptr mask = makeMesh( ms, MASK_VERTICES, MASK_FACES);
+            if ( mask)
+            {
+                // Always ensure that the model is loaded aligned if mask available (as for 3DF).
+                const r3d::Mat4f T = MaskRegistration::calcMaskAlignment( *mask);
+                fm->addTransformMatrix( T.inverse());
+                fm->fixTransformMatrix();
+                fm->setMask( mask);
+            }   // end if
+            else
+                err = "Couldn't load mask!";
+        }   // end if
+    }   // end if
+
+    file.unmap( data);
+    file.close();
+
+    if ( !err.isEmpty())
+    {
+        delete fm;
+        fm = nullptr;
+    }   // end if
+
+    return fm;
+}   // end read
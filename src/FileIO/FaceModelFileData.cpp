@@ -19,7 +19,6 @@
 #include <LndMrk/LandmarksManager.h>
 #include <Metric/PhenotypeManager.h>
 #include <Metric/MetricManager.h>
-#include <QTemporaryDir>
 
 using FaceTools::FileIO::FaceModelFileData;
 using FaceTools::FileIO::Content;
@@ -198,9 +197,8 @@ FaceModelFileData::FaceModelFileData( const FM &fm)
 FaceModelFileData::FaceModelFileData( const QString &fpath, const QString &assessorName)
     : _fm( &_ifm)
 {
-    QTemporaryDir tdir;
     PTree ptree;
-    _err = readMeta( fpath, tdir, ptree);
+    _err = readMeta( fpath, ptree);   // Metadata only
     double fversion = 0.0;
     if ( !_err.isEmpty() || !importMetaData( _ifm, ptree, fversion))
         return;
@@ -19,6 +19,8 @@
 #include <MiscFunctions.h>
 #include <FaceModel.h>
 #include <FaceTools.h>
+#include <QReadWriteLock>
+#include <QMutex>
 #include <QFileInfo>
 #include <QDebug>
 #include <cassert>
@@ -34,20 +36,59 @@ FaceModelFileHandlerMap FaceModelManager::_fhmap;
 FMS FaceModelManager::_models;
 std::unordered_map<FM*, QString> FaceModelManager::_mdata;
 std::unordered_map<QString, FM*> FaceModelManager::_mfiles;    // Lookup models by current filepath
-QString FaceModelManager::_err;
+QStringSet FaceModelManager::_loading;
+
+
+namespace {
+QReadWriteLock s_lock;  // Guards _models, _mdata, _mfiles, _loading and s_hlocks
+QMutex s_wlock;         // Serialises writes
+std::unordered_map<const FaceModelFileHandler*, std::shared_ptr<QMutex> > s_hlocks;  // Serialises reads per handler
+thread_local QString s_err;
+}   // end namespace
 
 
 void FaceModelManager::setLoadLimit( size_t llimit) { _loadLimit = llimit;}
 
 
-void FaceModelManager::add( FaceModelFileHandler* fii) { if ( fii) _fhmap.add(fii);}
+void FaceModelManager::add( FaceModelFileHandler* fii)
+{
+    if ( !fii)
+        return;
+    _fhmap.add(fii);
+    if ( !fii->canReadConcurrently())
+    {
+        s_lock.lockForWrite();
+        if ( s_hlocks.count(fii) == 0)
+            s_hlocks[fii] = std::shared_ptr<QMutex>( new QMutex);
+        s_lock.unlock();
+    }   // end if
+}   // end add
+
+
+const QString& FaceModelManager::error() { return s_err;}
+
+
+size_t FaceModelManager::numOpen()
+{
+    s_lock.lockForRead();
+    const size_t n = _mdata.size();
+    s_lock.unlock();
+    return n;
+}   // end numOpen
+
+
+FMS FaceModelManager::opened()
+{
+    s_lock.lockForRead();
+    const FMS fms = _models;
+    s_lock.unlock();
+    return fms;
+}   // end opened
 
 
 bool FaceModelManager::hasPreferredFileFormat( const FM* fm)
 {
-    assert( fm != nullptr);
-    assert( _models.count(const_cast<FM*>(fm)) > 0);
-    return isPreferredFileFormat( _mdata.at(const_cast<FM*>(fm)));
+    return isPreferredFileFormat( filepath( fm));
 }   // end hasPreferredFileFormat
 
 
@@ -71,8 +112,7 @@ void FaceModelManager::_setModelFilepath( const FM* cfm, const QString& fname)
 bool FaceModelManager::write( const FM* cfm, QString &fpath)
 {
     FM* fm = const_cast<FM*>(cfm);
-    assert( _models.count(fm) > 0);
-    QString savefilepath = _mdata.at(fm);
+    QString savefilepath = filepath( fm);
     QString delfilepath;    // Will not be empty if replacing filename
     if ( fpath.isEmpty())
         fpath = savefilepath;
@@ -82,23 +122,31 @@ bool FaceModelManager::write( const FM* cfm, QString &fpath)
         savefilepath = fpath;
     }   // end else
 
-    _err = "";  // Reset the error
+    s_err = "";  // Reset the error
     FaceModelFileHandler* fileio = _fhmap.writeInterface( savefilepath);
     if ( !fileio)
-        _err = "File \"" + savefilepath + "\" is not an allowed file type!";
+        s_err = "File \"" + savefilepath + "\" is not an allowed file type!";
     else if ( !fileio->canWrite())
-        _err = "Cannot write to " + fileio->getFileDescription() + " files!";
-    else if ( !fileio->write( fm, savefilepath))
-        _err = fileio->error();
-    else    // Successful write
+        s_err = "Cannot write to " + fileio->getFileDescription() + " files!";
+    else
     {
+        s_wlock.lock();
+        if ( !fileio->write( fm, savefilepath))
+            s_err = fileio->error();
+        s_wlock.unlock();
+    }   // end else
+
+    if ( s_err.isEmpty())   // Successful write
+    {
+        s_lock.lockForWrite();
         _mfiles.erase(delfilepath);
         _setModelFilepath( fm, savefilepath);
+        s_lock.unlock();
         fm->setModelSaved( fileio->canWriteTextures() || !fm->hasTexture());
         fm->setMetaSaved( isPreferredFileFormat(savefilepath) || !fm->hasMetaData());
-    }   // end else
+    }   // end if
 
-    return _err.isEmpty();
+    return s_err.isEmpty();
 }   // end write
 
 
@@ -136,7 +184,10 @@ bool FaceModelManager::canSaveTextures( const QString &fpath)
 bool FaceModelManager::isOpen( const QString& fn)
 {
     const QFileInfo finfo(fn);
-    return _mfiles.count( finfo.filePath()) > 0;
+    s_lock.lockForRead();
+    const bool isopen = _mfiles.count( finfo.filePath()) > 0;
+    s_lock.unlock();
+    return isopen;
 }   // end isOpen
 
 
@@ -145,10 +196,17 @@ FM* FaceModelManager::read( const QString& fn)
     const QFileInfo finfo(fn);
     const QString fname = finfo.filePath();
 
-    _err = "";
-    if ( _mfiles.count(fname) > 0)
+    s_err = "";
+    // Reserve the filepath so no other thread can read in the same model at the same time
+    s_lock.lockForWrite();
+    const bool isopen = _mfiles.count(fname) > 0 || _loading.count(fname) > 0;
+    if ( !isopen)
+        _loading.insert(fname);
+    s_lock.unlock();
+
+    if ( isopen)
     {
-        _err = "File \"" + fname + "\" already open!";
+        s_err = "File \"" + fname + "\" already open!";
         std::cerr << "Model already loaded!" << std::endl;
         return nullptr;
     }   // end if
@@ -156,37 +214,58 @@ FM* FaceModelManager::read( const QString& fn)
     FaceModelFileHandler* fileio = nullptr;
     FM* fm = nullptr;
     if ( !finfo.exists())
-        _err = "File \"" + fname + "\" does not exist!";
+        s_err = "File \"" + fname + "\" does not exist!";
     else if ( (fileio = _fhmap.readInterface(fname)) == nullptr)
-        _err = "File \"" + fname + "\" is not an allowed file type!";
+        s_err = "File \"" + fname + "\" is not an allowed file type!";
     else if ( !fileio->canRead())
-        _err = "Cannot read from " + fileio->getFileDescription() + " files!";
-    else if ( (fm = fileio->read( fname)) == nullptr)
-        _err = fileio->error();
+        s_err = "Cannot read from " + fileio->getFileDescription() + " files!";
     else
     {
-        _setModelFilepath( fm, fname);
+        s_lock.lockForRead();
+        const std::shared_ptr<QMutex> hlock = s_hlocks.count(fileio) > 0 ? s_hlocks.at(fileio) : nullptr;
+        s_lock.unlock();
+        if ( hlock)
+            hlock->lock();
+        if ( (fm = fileio->read( fname)) == nullptr)
+            s_err = fileio->error();
+        if ( hlock)
+            hlock->unlock();
+    }   // end else
+
+    if ( fm)
+    {
         fm->setModelSaved( true);
         fm->setMetaSaved( true);
-    }   // end else
+    }   // end if
+
+    s_lock.lockForWrite();
+    _loading.erase(fname);
+    if ( fm)
+        _setModelFilepath( fm, fname);
+    s_lock.unlock();
 
     return fm;
 }   // end read
 
 
-const QString& FaceModelManager::filepath( const FM* fm)
+QString FaceModelManager::filepath( const FM* fm)
 {
     assert( fm);
+    s_lock.lockForRead();
     assert( _models.count(const_cast<FM*>(fm)) > 0);
-    return _mdata.at(const_cast<FM*>(fm));
+    const QString fpath = _mdata.at(const_cast<FM*>(fm));
+    s_lock.unlock();
+    return fpath;
 }   // end filepath
 
 
 FM* FaceModelManager::model( const QString& fname)
 {
     FM* fm = nullptr;
+    s_lock.lockForRead();
     if ( _mfiles.count(fname) > 0)
         fm = _mfiles.at(fname);
+    s_lock.unlock();
     return fm;
 }   // end model
 
@@ -194,10 +273,12 @@ FM* FaceModelManager::model( const QString& fname)
 void FaceModelManager::close( const FM* cfm)
 {
     FM* fm = const_cast<FM*>(cfm);
+    s_lock.lockForWrite();
     assert(_models.count(fm) > 0);
     _mfiles.erase(_mdata.at(fm));
     _models.erase(fm);
     _mdata.erase(fm);
+    s_lock.unlock();
     delete fm;
 }   // end close
 
@@ -25,6 +25,8 @@
 #include <r3dio/IOHelpers.h>
 #include <QTemporaryDir>
 #include <quazip5/JlCompress.h>
+#include <quazip5/quazipfile.h>
+#include <quazip5/quazip.h>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/algorithm/string.hpp>
 #include <sstream>
@@ -112,14 +114,15 @@ PTree& exportXMLHeader( PTree& tree)
 bool FaceModelXMLFileHandler::write( const FM* fm, const QString& fname)
 {
     assert(fm);
-    _err = "";
+    QString &err = _err.localData();   // Error for the calling thread
+    err = "";
 
     try
     {
         QTemporaryDir tdir( QDir::tempPath() + "/" + QFileInfo( fname).baseName());
         if ( !tdir.isValid())
         {
-            _err = "Unable to create temporary directory for writing to!";
+            err = "Unable to create temporary directory for writing to!";
             return false;
         }   // end if
 
@@ -127,7 +130,7 @@ bool FaceModelXMLFileHandler::write( const FM* fm, const QString& fname)
         ofs.open( tdir.filePath( "meta.xml").toLocal8Bit().toStdString());
         if ( !ofs.is_open())
         {
-            _err = "Cannot open output file stream for writing metadata!";
+            err = "Cannot open output file stream for writing metadata!";
             return false;
         }   // end if
 
@@ -141,14 +144,14 @@ bool FaceModelXMLFileHandler::write( const FM* fm, const QString& fname)
         // Write out the model geometry itself into .obj format.
         if ( !r3dio::saveAsOBJ( fm->mesh(), tdir.filePath( "mesh.obj").toLocal8Bit().toStdString(), false/*as jpeg*/))
         {
-            _err = "Failed to write mesh!";
+            err = "Failed to write mesh!";
             return false;
         }   // end if
 
         // Write out the mask if set
         if ( fm->hasMask() && !r3dio::saveAsPLY( fm->mask(), tdir.filePath( "mask.ply").toLocal8Bit().toStdString()))
         {
-            _err = "Failed to write mask!";
+            err = "Failed to write mask!";
             return false;
         }   // end if
 
@@ -158,15 +161,15 @@ bool FaceModelXMLFileHandler::write( const FM* fm, const QString& fname)
 
         // Finally, zip up the contents of the directory into fname.
         if ( !JlCompress::compressDir( fname, tdir.path(), true/*recursively pack subdirs*/))
-            _err = "Unable to compress saved data into archive format!";
+            err = "Unable to compress saved data into archive format!";
     }   // end try
     catch ( const std::exception& e)
     {
         std::cerr << "[EXCEPTION] FaceTools::FileIO::FaceModelXMLFileHandler::write: Failed to write to " << fname.toStdString() << std::endl;
-        _err = e.what();
+        err = e.what();
     }   // end catch
 
-    return _err.isEmpty();
+    return err.isEmpty();
 }   // end write
 
 
@@ -394,33 +397,14 @@ bool FaceTools::FileIO::importMetaData( FM &fm, const PTree& tree, double &fvers
 }   // end importMetaData
 
 
-QString FaceTools::FileIO::readMeta( const QString &fname, QTemporaryDir &tdir, PTree &tree)
+namespace {
+
+QString readXML( std::istream &is, PTree &tree)
 {
     QString err;
-
     try
     {
-        if ( !tdir.isValid())
-            return "Unable to open temporary directory for reading from!";
-
-        QStringList fnames = JlCompress::extractDir( fname, tdir.path());
-        if ( fnames.isEmpty())
-            return "Unable to extract files from archive!";
-
-        QStringList xmlList = QDir( tdir.path()).entryList( {"*.xml"});
-        QString xmlfile;
-        if ( xmlList.size() == 1)
-            xmlfile = tdir.filePath( xmlList.first());
-
-        if ( xmlfile.isEmpty() || !QFileInfo(xmlfile).isFile())
-            return "Cannot find metadata in archive!";
-
-        std::ifstream ifs;
-        ifs.open( xmlfile.toLocal8Bit().toStdString());
-        if ( !ifs.is_open())
-            return "Cannot open metadata file for reading!";
-
-        boost::property_tree::read_xml( ifs, tree);
+        boost::property_tree::read_xml( is, tree);
     }   // end try
     catch ( const boost::property_tree::ptree_bad_path&)
     {
@@ -434,8 +418,70 @@ QString FaceTools::FileIO::readMeta( const QString &fname, QTemporaryDir &tdir,
     {
         err = "Unable to read in stream data!";
     }   // end catch
-
     return err;
+}   // end readXML
+
+}   // end namespace
+
+
+QString FaceTools::FileIO::readMeta( const QString &fname, QTemporaryDir &tdir, PTree &tree)
+{
+    if ( !tdir.isValid())
+        return "Unable to open temporary directory for reading from!";
+
+    QStringList fnames = JlCompress::extractDir( fname, tdir.path());
+    if ( fnames.isEmpty())
+        return "Unable to extract files from archive!";
+
+    QStringList xmlList = QDir( tdir.path()).entryList( {"*.xml"});
+    QString xmlfile;
+    if ( xmlList.size() == 1)
+        xmlfile = tdir.filePath( xmlList.first());
+
+    if ( xmlfile.isEmpty() || !QFileInfo(xmlfile).isFile())
+        return "Cannot find metadata in archive!";
+
+    std::ifstream ifs;
+    ifs.open( xmlfile.toLocal8Bit().toStdString());
+    if ( !ifs.is_open())
+        return "Cannot open metadata file for reading!";
+
+    return readXML( ifs, tree);
+}   // end readMeta
+
+
+QString FaceTools::FileIO::readMeta( const QString &fname, PTree &tree)
+{
+    QuaZip zip( fname);
+    if ( !zip.open( QuaZip::mdUnzip))
+        return "Unable to open archive!";
+
+    // Find the single XML entry at the top level of the archive (only the central directory is read).
+    QString xmlname;
+    int nxml = 0;
+    for ( bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+    {
+        const QString name = zip.getCurrentFileName();
+        if ( !name.contains('/') && name.endsWith( ".xml", Qt::CaseInsensitive))
+        {
+            xmlname = name;
+            nxml++;
+        }   // end if
+    }   // end for
+
+    if ( nxml != 1 || !zip.setCurrentFile( xmlname))
+        return "Cannot find metadata in archive!";
+
+    // Decompress just this entry into memory
+    QuaZipFile zfile( &zip);
+    if ( !zfile.open( QIODevice::ReadOnly))
+        return "Cannot open metadata in archive for reading!";
+    const QByteArray bytes = zfile.readAll();
+    zfile.close();
+    zip.close();
+
+    std::istringstream iss( bytes.toStdString());
+    return readXML( iss, tree);
 }   // end readMeta
 
 
@@ -484,34 +530,36 @@ QString FaceTools::FileIO::loadData( FM &fm, const QTemporaryDir &tdir, const QS
 
 FM* FaceModelXMLFileHandler::read( const QString& fname)
 {
-    _err = "";
+    QString &err = _err.localData();   // Error for the calling thread
+    err = "";
 
     QTemporaryDir tdir;
     if ( !tdir.isValid())
     {
-        _err = "Unable to create temporary directory for file extraction!";
+        err = "Unable to create temporary directory for file extraction!";
         return nullptr;
     }   // end if
 
     FM *fm = new FM;
     PTree tree;
-    _err = readMeta( fname, tdir, tree);
-    if ( _err.isEmpty())
+    err = readMeta( fname, tdir, tree);
+    if ( err.isEmpty())
     {
-        _fversion = 0.0;
+        double &fversion = _fversion.localData();
+        fversion = 0.0;
         QString meshfname, maskfname;
-        if ( !importMetaData( *fm, tree, _fversion, meshfname, maskfname))
-            _err = QObject::tr("No FaceModel objects recorded in file!");
+        if ( !importMetaData( *fm, tree, fversion, meshfname, maskfname))
+            err = QObject::tr("No FaceModel objects recorded in file!");
         else
         {
-            if ( _fversion > XML_VERSION.toDouble())
-                _err = QObject::tr("File version is more recent than this library allows!");
+            if ( fversion > XML_VERSION.toDouble())
+                err = QObject::tr("File version is more recent than this library allows!");
             else
-                _err = loadData( *fm, tdir, meshfname, maskfname);
+                err = loadData( *fm, tdir, meshfname, maskfname);
         }   // end else
     }   // end if
 
-    if ( !_err.isEmpty())
+    if ( !err.isEmpty())
     {
         delete fm;
         fm = nullptr;
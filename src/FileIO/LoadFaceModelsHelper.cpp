@@ -16,9 +16,10 @@
  ************************************************************************/
 
 #include <FileIO/LoadFaceModelsHelper.h>
-#include <FileIO/FaceModelManager.h>
+#include <FileIO/ParallelModelLoader.h>
 #include <FaceModel.h>
 #include <QMessageBox>
+#include <QMutex>
 #include <QFile>
 using FaceTools::FileIO::LoadFaceModelsHelper;
 using FMM = FaceTools::FileIO::FaceModelManager;
@@ -80,18 +81,30 @@ int LoadFaceModelsHelper::setFilteredFilenames( const QStringList& fnames)
 }   // end setFilteredFilenames
 
 
-size_t LoadFaceModelsHelper::loadModels()
+size_t LoadFaceModelsHelper::loadModels( const std::function<void(FM*)> &onLoaded)
 {
     _loaded.clear();
     _failnames.clear();
-    for ( const QString& fname : _filenames)
+
+    // Models are emitted from the loader's worker threads as they finish
+    QMutex mutex;
+    ParallelModelLoader loader;
+    QObject::connect( &loader, &ParallelModelLoader::loadedModel, [&]( FM* fm)
     {
-        FM* fm = FMM::read( fname);   // Blocks
-        if ( fm)
-            _loaded.insert( fm);
-        else
-            _failnames[FMM::error()] << fname;
-    }   // end for
+        mutex.lock();
+        _loaded.insert( fm);
+        mutex.unlock();
+        if ( onLoaded)
+            onLoaded( fm);
+    });
+    QObject::connect( &loader, &ParallelModelLoader::failedModel, [&]( const QString& fname, const QString& err)
+    {
+        mutex.lock();
+        _failnames[err] << fname;
+        mutex.unlock();
+    });
+    loader.load( _filenames);   // Blocks
+
     _filenames.clear();
     return _loaded.size();
 }   // end loadModels
@@ -0,0 +1,70 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <FileIO/ParallelModelLoader.h>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QThread>
+#include <functional>
+using FaceTools::FileIO::ParallelModelLoader;
+using FMM = FaceTools::FileIO::FaceModelManager;
+using FaceTools::FM;
+
+
+namespace {
+class LoadTask : public QRunnable
+{
+public:
+    explicit LoadTask( const std::function<void()> &fn) : _fn(fn) {}
+    void run() override { _fn();}
+private:
+    const std::function<void()> _fn;
+};  // end class
+}   // end namespace
+
+
+ParallelModelLoader::ParallelModelLoader( size_t maxThreads)
+    : _maxThreads( maxThreads > 0 ? maxThreads : size_t(std::max( 1, QThread::idealThreadCount()))), _cancelled(false) {}
+
+
+size_t ParallelModelLoader::load( const QStringList& fpaths)
+{
+    _cancelled = false;
+    std::atomic<size_t> nloaded(0);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount( int(std::min( _maxThreads, size_t(std::max( 1, fpaths.size())))));
+    for ( const QString& fpath : fpaths)
+    {
+        pool.start( new LoadTask( [this, fpath, &nloaded]()
+        {
+            if ( _cancelled)
+                return;
+            FM *fm = FMM::read( fpath);
+            if ( fm)
+            {
+                ++nloaded;
+                emit loadedModel( fm);
+            }   // end if
+            else
+                emit failedModel( fpath, FMM::error());
+        }));
+    }   // end for
+    pool.waitForDone();
+
+    return nloaded;
+}   // end load
@@ -16,30 +16,46 @@
  ************************************************************************/
 
 #include <MaskRegistration.h>
+#include <ViscoElasticRegistration.h>
 #include <FileIO/FaceModelXMLFileHandler.h>
 #include <FileIO/FaceModelManager.h>
 #include <FaceModelViewer.h>
+#include <MiscFunctions.h>
 #include <rNonRigid.h>
 #include <FaceModel.h>
+#include <QStandardPaths>
 #include <QMessageBox>
+#include <QSaveFile>
 #include <QFileInfo>
+#include <QDateTime>
 #include <QThread>
+#include <QDir>
 #include <r3d/ProcrustesSuperimposition.h>
 #include <boost/filesystem/path.hpp>
 #include <boost/functional/hash.hpp>
+#include <cstring>
+#include <cassert>
 //#include <thread>
 using FaceTools::MaskRegistration;
 using FaceTools::Vis::FV;
+using FaceTools::MatX3f;
+using FaceTools::Mat4f;
 using FaceTools::FM;
 using FMM = FaceTools::FileIO::FaceModelManager;
 
 
-MaskRegistration::MaskData MaskRegistration::s_mask;
-QReadWriteLock MaskRegistration::s_lock;
+MaskRegistration::MaskPtr MaskRegistration::s_mask( new MaskRegistration::MaskData);
+QReadWriteLock MaskRegistration::s_cacheLock;
 MaskRegistration::Params MaskRegistration::s_params;
+QString MaskRegistration::s_cacheDir;
+bool MaskRegistration::s_cacheDirSet(false);
+qint64 MaskRegistration::s_cacheLimit(256 * 1024 * 1024);
 
 
-MaskRegistration::MaskData::MaskData() : mask(nullptr) {}
+MaskRegistration::MaskData::MaskData() : mask(nullptr), hash(0) {}
+
+
+MaskRegistration::MaskData::~MaskData() { delete mask;}
 
 
 MaskRegistration::Params::Params()
@@ -48,11 +64,47 @@ MaskRegistration::Params::Params()
       smoothK(80), sigmaSmooth(3.0f),
       numViscousStart(100), numViscousEnd(1),
       numElasticStart(100), numElasticEnd(1),
-      numUpdateIts(20)
+      numUpdateIts(20), parallel(false)
 {
 }   // end ctor
 
 
+MaskRegistration::Params MaskRegistration::Params::fast()
+{
+    Params p;
+    p.numInlierIts = 5;
+    p.smoothK = 40;
+    p.numViscousStart = 30;
+    p.numElasticStart = 30;
+    p.levels = {{4.0f, 7}};
+    p.numUpdateIts = 3;
+    p.parallel = true;
+    return p;
+}   // end fast
+
+
+MaskRegistration::Params MaskRegistration::Params::standard()
+{
+    Params p;
+    p.levels = {{4.0f, 8}, {2.0f, 6}};
+    p.numUpdateIts = 6;
+    p.parallel = true;
+    return p;
+}   // end standard
+
+
+MaskRegistration::Params MaskRegistration::Params::precise()
+{
+    Params p;
+    p.numInlierIts = 20;
+    p.numViscousStart = 150;
+    p.numElasticStart = 150;
+    p.numUpdateIts = 40;
+    p.parallel = true;
+    return p;
+}   // end precise
+
+
 namespace {
 
 void setBarycentricLandmarkPositions( std::unordered_map<int, std::pair<int, r3d::Vec3f> >& tset,
@@ -101,36 +153,106 @@ size_t createHash( const r3d::Mesh &mesh)
     return h;
 }   // end createHash
 
+
+// Set the laterally opposite vertex IDs and the quadrant and medial membership of the mask's vertices.
+void setOppositeVertices( MaskRegistration::MaskData &mdata)
+{
+    const r3d::Mesh &mesh = mdata.mask->mesh();
+    const r3d::KDTree &kdt = mdata.mask->kdtree();
+    assert( mesh.hasSequentialIds());
+    const size_t N = mesh.numVtxs();
+
+    // Reflect each vertex through the medial plane and find the closest vertex to the reflected position.
+    // It is assumed that the medial plane lies at X=0 and that the mesh is upright and laterally symmetric.
+    std::vector<int> nearest( N);
+    std::vector<uint8_t> qflags( N);
+    FaceTools::parallelChunks( N, [&]( size_t i0, size_t i1)
+    {
+        for ( size_t i = i0; i < i1; ++i)
+        {
+            const Vec3f &p = mesh.vtx(int(i));
+            nearest[i] = kdt.find( Vec3f( -p[0], p[1], p[2]));
+
+            // Partitioning of the vertices into the four quadrants is not mutually exclusive.
+            uint8_t flags = 0;
+            if ( p[0] >= 0)
+            {
+                if ( p[1] >= 0)
+                    flags |= MaskRegistration::MaskData::Q0;
+                if ( p[1] <= 0)
+                    flags |= MaskRegistration::MaskData::Q3;
+            }   // end if
+            if ( p[0] <= 0)
+            {
+                if ( p[1] >= 0)
+                    flags |= MaskRegistration::MaskData::Q1;
+                if ( p[1] <= 0)
+                    flags |= MaskRegistration::MaskData::Q2;
+            }   // end if
+            qflags[i] = flags;
+        }   // end for
+    }, 256);
+
+    // Pair up vertices (each pairing depends on those before it so this is serial but cheap). Vertices are
+    // visited in the mesh's vertex ID set order, and vertices already paired as the opposite of an earlier
+    // vertex are skipped and left out of the quadrant and medial sets, as when this was done in one pass.
+    mdata.opposite.assign( N, -1);
+    mdata.vflags.assign( N, 0);
+    for ( int vidx : mesh.vtxIds())
+    {
+        if ( mdata.opposite[vidx] >= 0)
+            continue;
+        const int ovidx = nearest[vidx];
+        mdata.opposite[ovidx] = vidx;
+        mdata.opposite[vidx] = ovidx;
+        mdata.vflags[vidx] = qflags[vidx];
+        if ( ovidx == vidx)
+            mdata.vflags[vidx] |= MaskRegistration::MaskData::MEDIAL;
+    }   // end for
+
+    // Sparse versions
+    for ( size_t i = 0; i < N; ++i)
+    {
+        const int vidx = int(i);
+        mdata.oppVtxs[vidx] = mdata.opposite[i];
+        if ( mdata.isMedial( vidx))
+            mdata.medialVtxs.insert( vidx);
+        if ( mdata.inQuadrant( vidx, 0))
+            mdata.q0.insert( vidx);
+        if ( mdata.inQuadrant( vidx, 1))
+            mdata.q1.insert( vidx);
+        if ( mdata.inQuadrant( vidx, 2))
+            mdata.q2.insert( vidx);
+        if ( mdata.inQuadrant( vidx, 3))
+            mdata.q3.insert( vidx);
+    }   // end for
+}   // end setOppositeVertices
+
 }   // end namespace
 
 
 void MaskRegistration::unsetMask()
 {
-    if ( s_mask.mask)
-    {
-        delete s_mask.mask;
-        s_mask.mask = nullptr;
-        s_mask.path = "";
-        s_mask.hash = 0;
-    }   // end if
+    // The old mask is deleted once the last reader releases its snapshot
+    std::atomic_store( &s_mask, MaskPtr( new MaskData));
 }   // end unsetMask
 
 
 bool MaskRegistration::setMask( const QString &mpath)
 {
     const QString abspath = QFileInfo( mpath).absoluteFilePath();
-    if ( s_mask.path == abspath)
+    if ( maskData()->path == abspath)
         return true;
 
     unsetMask();
+    MaskPtr unset = maskData();   // Replaced when loaded unless another mask is set before then
 
     if ( !FMM::canRead( mpath) || !FMM::isPreferredFileFormat( mpath))
         return false;
 
-    // Load meta data - fail if no landmarks present.
+    // Load just the meta data first - fail if no landmarks present.
     PTree ptree;
-    QTemporaryDir *tdir = new QTemporaryDir;
-    FileIO::readMeta( mpath, *tdir, ptree);
+    FileIO::readMeta( mpath, ptree);
 
     FM *fm = new FM;
     double fversion;
@@ -155,65 +277,38 @@ bool MaskRegistration::setMask( const QString &mpath)
 
     //std::cout << "Loading anthropomorphic mask for surface registration..." << std::endl;
     QThread *thread = QThread::create(
-        [abspath, meshfname, tdir, fm]()
+        [abspath, meshfname, fm, unset]()
         {
+            std::shared_ptr<MaskData> mdata( new MaskData);
+            mdata->mask = fm;   // Deleted with the snapshot
+
+            // Extract the archive for the mesh
+            QTemporaryDir tdir;
+            PTree unusedTree;
             QString unused;
-            const QString err = FileIO::loadData( *fm, *tdir, meshfname, unused);
+            QString err = FileIO::readMeta( abspath, tdir, unusedTree);
+            if ( err.isEmpty())
+                err = FileIO::loadData( *fm, tdir, meshfname, unused);
             if ( err.isEmpty())
             {
-                s_lock.lockForWrite();
-                s_mask.mask = fm;
-                s_mask.path = abspath;
-                s_mask.hash = createHash( fm->mesh());
+                mdata->path = abspath;
+                mdata->hash = createHash( fm->mesh());
 
                 // Note that there's an opportunity here to have a mask store several different
                 // sets of landmarks (perhaps derived from different assessors of whatever).
                 const Landmark::LandmarkSet& lmset = fm->currentLandmarks();
-                setBarycentricLandmarkPositions( s_mask.lmksL, lmset.lateral( LEFT), fm->kdtree());
-                setBarycentricLandmarkPositions( s_mask.lmksM, lmset.lateral( MID), fm->kdtree());
-                setBarycentricLandmarkPositions( s_mask.lmksR, lmset.lateral( RIGHT), fm->kdtree());
-
-                // Set the laterally opposite vertex IDs:
-                for ( int vidx : fm->mesh().vtxIds())
-                {
-                    if ( s_mask.oppVtxs.count(vidx) > 0)
-                        continue;
-
-                    // Reflect the vertex through the medial plane and find the closest opposite vertex.
-                    // It is assumed that the medial plane lies at X=0 and that the mesh is upright and laterally symmetric.
-                    const Vec3f &p = fm->mesh().vtx(vidx);
-                    const int ovidx = fm->kdtree().find( Vec3f( -p[0], p[1], p[2]));
-                    s_mask.oppVtxs[ovidx] = vidx;
-                    s_mask.oppVtxs[vidx] = ovidx;
-                    if ( ovidx == vidx)
-                       s_mask.medialVtxs.insert(vidx);
-
-                    // Partitioning of the vertices into the four quadrants is not mutually exclusive.
-                    if ( p[0] >= 0)
-                    {
-                        if ( p[1] >= 0)
-                            s_mask.q0.insert(vidx);
-                        if ( p[1] <= 0)
-                            s_mask.q3.insert(vidx);
-                    }   // end if
-
-                    if ( p[0] <= 0)
-                    {
-                        if ( p[1] >= 0)
-                            s_mask.q1.insert(vidx);
-                        if ( p[1] <= 0)
-                            s_mask.q2.insert(vidx);
-                    }   // end else if
-                }   // end for
-
-                s_lock.unlock();
+                setBarycentricLandmarkPositions( mdata->lmksL, lmset.lateral( LEFT), fm->kdtree());
+                setBarycentricLandmarkPositions( mdata->lmksM, lmset.lateral( MID), fm->kdtree());
+                setBarycentricLandmarkPositions( mdata->lmksR, lmset.lateral( RIGHT), fm->kdtree());
+
+                setOppositeVertices( *mdata);
+
+                // Publish the snapshot only if no other mask was set (or unset) while loading
+                MaskPtr expected = unset;
+                std::atomic_compare_exchange_strong( &s_mask, &expected, MaskPtr( mdata));
             }   // end if
             else
-            {
                 std::cerr << "Failed to load mask data!" << std::endl;
-                delete fm;
-            }   // end else
-            delete tdir;
         });
     QObject::connect( thread, &QThread::finished, [thread](){ thread->deleteLater();});
     thread->start();
@@ -222,66 +317,167 @@ bool MaskRegistration::setMask( const QString &mpath)
 }   // end setMask
 
 
-bool MaskRegistration::maskLoaded()
+bool MaskRegistration::maskLoaded() { return maskData()->mask != nullptr;}
+
+
+QString MaskRegistration::maskPath() { return maskData()->path;}
+
+
+size_t MaskRegistration::maskHash() { return maskData()->hash;}
+
+
+MaskRegistration::MaskPtr MaskRegistration::maskData() { return std::atomic_load( &s_mask);}
+
+
+void MaskRegistration::setParams( const MaskRegistration::Params &prms) { s_params = prms;}
+
+
+MaskRegistration::Params MaskRegistration::params() { return s_params;}
+
+
+r3d::Mesh::Ptr MaskRegistration::registerMask( const FM *fm, const CancelFn &cfn, Mat4f *align)
 {
-    if ( !s_lock.tryLockForRead())
-        return false;
-    const bool loaded = s_mask.mask != nullptr;
-    s_lock.unlock();
-    return loaded;
-}   // end maskLoaded
+    return registerMask( fm, s_params, cfn, align);
+}   // end registerMask
 
 
-QString MaskRegistration::maskPath()
+namespace {
+
+const char CACHE_MAGIC[8] = "3DFREG";
+const uint32_t CACHE_VERSION = 2;
+
+struct CacheHeader
 {
-    QString mpath;
-    s_lock.lockForRead();
-    mpath = s_mask.path;
-    s_lock.unlock();
-    return mpath;
-}   // end maskPath
+    char magic[8];
+    uint32_t version;
+    uint32_t nvtxs;
+    uint64_t meshHash;
+    uint64_t maskHash;
+    uint64_t prmsHash;
+};  // end struct
 
 
-size_t MaskRegistration::maskHash()
+size_t hashParams( const MaskRegistration::Params &p)
 {
     size_t h = 0;
-    s_lock.lockForRead();
-    h = s_mask.hash;
-    s_lock.unlock();
+    boost::hash_combine( h, p.k);
+    boost::hash_combine( h, p.flagThresh);
+    boost::hash_combine( h, p.eqPushPull);
+    boost::hash_combine( h, p.kappa);
+    boost::hash_combine( h, p.useOrient);
+    boost::hash_combine( h, p.numInlierIts);
+    boost::hash_combine( h, p.smoothK);
+    boost::hash_combine( h, p.sigmaSmooth);
+    boost::hash_combine( h, p.numViscousStart);
+    boost::hash_combine( h, p.numViscousEnd);
+    boost::hash_combine( h, p.numElasticStart);
+    boost::hash_combine( h, p.numElasticEnd);
+    boost::hash_combine( h, p.numUpdateIts);
+    boost::hash_combine( h, p.parallel);
+    for ( const MaskRegistration::Params::Level &lvl : p.levels)
+    {
+        boost::hash_combine( h, lvl.cellSize);
+        boost::hash_combine( h, lvl.numUpdateIts);
+    }   // end for
     return h;
-}   // end maskHash
+}   // end hashParams
 
 
-std::shared_ptr<const MaskRegistration::MaskData> MaskRegistration::maskData()
+// Registration uses transformed positions so the model's transform is hashed along with its mesh.
+size_t hashModel( const r3d::Mesh &mesh)
 {
-    s_lock.lockForRead();
-    return std::shared_ptr<const MaskData>( &s_mask, []( const MaskData*){ s_lock.unlock();});
-}   // end maskData
+    size_t h = createHash( mesh);
+    const r3d::Mat4f &T = mesh.transformMatrix();
+    for ( int i = 0; i < 16; ++i)
+        boost::hash_combine( h, T.data()[i]);
+    return h;
+}   // end hashModel
 
 
-void MaskRegistration::setParams( const MaskRegistration::Params &prms) { s_params = prms;}
+QString cacheFilePath( const CacheHeader &hdr)
+{
+    const QString cdir = MaskRegistration::cacheDir();
+    if ( cdir.isEmpty())
+        return "";
+    size_t key = 0;
+    boost::hash_combine( key, hdr.meshHash);
+    boost::hash_combine( key, hdr.maskHash);
+    boost::hash_combine( key, hdr.prmsHash);
+    return QDir( cdir).filePath( QString("%1.reg").arg( quint64(key), 16, 16, QChar('0')));
+}   // end cacheFilePath
+
+
+// Entries are the header, the mask alignment matrix then the registered vertex rows.
+bool readCache( const QString &fpath, const CacheHeader &hdr, MatX3f &vrows, Mat4f &T)
+{
+    QFile file( fpath);
+    if ( fpath.isEmpty() || !file.open( QIODevice::ReadOnly))
+        return false;
+
+    CacheHeader fhdr;
+    if ( file.read( reinterpret_cast<char*>(&fhdr), sizeof(CacheHeader)) != qint64(sizeof(CacheHeader))
+            || memcmp( fhdr.magic, hdr.magic, sizeof(hdr.magic)) != 0 || fhdr.version != hdr.version
+            || fhdr.nvtxs != hdr.nvtxs || fhdr.meshHash != hdr.meshHash
+            || fhdr.maskHash != hdr.maskHash || fhdr.prmsHash != hdr.prmsHash)
+        return false;
+
+    Mat4f fT;
+    const qint64 tbytes = qint64( fT.size() * sizeof(float));
+    if ( file.read( reinterpret_cast<char*>( fT.data()), tbytes) != tbytes)
+        return false;
+
+    Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor> rows( hdr.nvtxs, 3);
+    const qint64 nbytes = qint64( rows.size() * sizeof(float));
+    if ( file.read( reinterpret_cast<char*>( rows.data()), nbytes) != nbytes)
+        return false;
+    vrows = rows;
+    T = fT;
+
+    // Mark as recently used so eviction removes it last
+    file.setFileTime( QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}   // end readCache
 
 
-r3d::Mesh::Ptr MaskRegistration::registerMask( const FM *fm)
+// Remove the least recently used entries from the given directory until their total size is within limit.
+void evictCache( const QString &cdir, qint64 limit)
 {
-    assert( maskLoaded());
-    if ( !maskLoaded())
+    const QFileInfoList finfos = QDir( cdir).entryInfoList( QStringList() << "*.reg", QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for ( const QFileInfo &finfo : finfos)    // Most recently used first
     {
-        std::cerr << "[ERROR] FaceTools::Action::MaskRegistration::registerMask: Mask not loaded!" << std::endl;
-        return nullptr;
+        total += finfo.size();
+        if ( total > limit)
+            QFile::remove( finfo.absoluteFilePath());
+    }   // end for
+}   // end evictCache
+
+
+void writeCache( const QString &fpath, const CacheHeader &hdr, const MatX3f &vrows, const Mat4f &T)
+{
+    if ( fpath.isEmpty() || !QDir().mkpath( QFileInfo( fpath).absolutePath()))
+        return;
+    const Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor> rows = vrows;
+    QSaveFile file( fpath);    // Atomic so concurrent registrations of the same data can't corrupt
+    if ( file.open( QIODevice::WriteOnly))
+    {
+        file.write( reinterpret_cast<const char*>(&hdr), sizeof(CacheHeader));
+        file.write( reinterpret_cast<const char*>( T.data()), qint64( T.size() * sizeof(float)));
+        file.write( reinterpret_cast<const char*>( rows.data()), qint64( rows.size() * sizeof(float)));
+        if ( !file.commit())
+            std::cerr << "[WARN] FaceTools::MaskRegistration::registerMask: Unable to write to cache!" << std::endl;
+        else
+            evictCache( QFileInfo( fpath).absolutePath(), MaskRegistration::cacheLimit());
     }   // end if
+}   // end writeCache
 
-    // Clone the loaded mask
-    s_lock.lockForRead();
-    r3d::Mesh::Ptr mask = s_mask.mask->mesh().deepCopy();
-    s_lock.unlock();
 
+// Returns the registered vertex rows or no rows if cancelled.
+MatX3f registerVertices( const FM *fm, const MaskRegistration::Params &prms, r3d::Mesh &mask, rNonRigid::Mesh &floating,
+                         const FaceTools::CancelFn &cfn)
+{
     //std::cout << "Calculating affine alignment (rigid + scaling) of mask to target face..." << std::endl;
 
-    rNonRigid::Mesh floating;
-    floating.features = mask->toFeatures( floating.topology, true/*use transformed*/);
-    floating.flags = rNonRigid::FlagVec::Ones( floating.features.rows());   // Use all vertices on the mask
-
     rNonRigid::Mesh target;
     target.features = fm->mesh().toFeatures( target.topology/*unused*/, true/*use transformed*/);
     target.flags = rNonRigid::FlagVec::Ones( target.features.rows());   // Use all vertices on the target
@@ -289,28 +485,151 @@ r3d::Mesh::Ptr MaskRegistration::registerMask( const FM *fm)
     const Mat4f T1 = rNonRigid::RigidRegistration()( floating, target);
 
     //std::cout << "Adding rigid transform to mask and reobtaining features..." << std::endl;
-    mask->addTransformMatrix( T1);
-    floating.features = mask->toFeatures( floating.topology, true/*use transformed*/);
+    mask.addTransformMatrix( T1);
+    floating.features = mask.toFeatures( floating.topology, true/*use transformed*/);
+
+    // Correspondence search and smoothing are multi-threaded
+    if ( prms.parallel)
+        return FaceTools::ViscoElasticRegistration( prms)( mask, fm->mesh(), fm->kdtree(), cfn);
 
     //std::cout << "Calculating non-rigid registration of mask to target face..." << std::endl;
-    rNonRigid::NonRigidRegistration( s_params.k, s_params.flagThresh, s_params.eqPushPull,
-                                     s_params.kappa, s_params.useOrient, s_params.numInlierIts,
-                                     s_params.smoothK, s_params.sigmaSmooth,
-                                     s_params.numViscousStart, s_params.numViscousEnd,
-                                     s_params.numElasticStart, s_params.numElasticEnd,
-                                     s_params.numUpdateIts)( floating, target);
-    //rNonRigid::FastDeformRegistration( s_params.numUpdateIts)( floating, target);
-
-    //std::cout << "Creating point cloud from registered vertices..." << std::endl;
+    const auto nonRigid = [&prms]( size_t nits)
+    {
+        return rNonRigid::NonRigidRegistration( prms.k, prms.flagThresh, prms.eqPushPull,
+                                                prms.kappa, prms.useOrient, prms.numInlierIts,
+                                                prms.smoothK, prms.sigmaSmooth,
+                                                prms.numViscousStart, prms.numViscousEnd,
+                                                prms.numElasticStart, prms.numElasticEnd, nits);
+    };  // end nonRigid
+
+    // Coarse to fine over sub-sampled targets before the final update at full resolution.
+    // The non-rigid registration can't be interrupted so cancellation is checked between levels.
+    for ( const MaskRegistration::Params::Level &lvl : prms.levels)
+    {
+        if ( FaceTools::CancelToken::isCancelled( cfn))
+            return MatX3f( 0, 3);
+        const std::vector<int> vidxs = FaceTools::subsampleVertices( fm->mesh(), lvl.cellSize);
+        rNonRigid::Mesh coarse;
+        coarse.features.resize( vidxs.size(), target.features.cols());
+        for ( size_t i = 0; i < vidxs.size(); ++i)
+            coarse.features.row(i) = target.features.row(vidxs[i]);
+        coarse.flags = rNonRigid::FlagVec::Ones( coarse.features.rows());
+        nonRigid( lvl.numUpdateIts)( floating, coarse);
+    }   // end for
+    if ( FaceTools::CancelToken::isCancelled( cfn))
+        return MatX3f( 0, 3);
+    nonRigid( prms.numUpdateIts)( floating, target);
+    //rNonRigid::FastDeformRegistration( prms.numUpdateIts)( floating, target);
+
     // On return, the vertices of feats are in correspondence with the surface of the model.
-    // Make a new r3d::Mesh object from the surface registered points.
-    r3d::Mesh::Ptr cmask = r3d::Mesh::fromVertices( floating.features.leftCols(3));
-    //std::cout << "Setting mesh topology..." << std::endl;
-    cmask->setFaces( floating.topology);
+    return floating.features.leftCols(3);
+}   // end registerVertices
+
+}   // end namespace
+
+
+r3d::Mesh::Ptr MaskRegistration::registerMask( const FM *fm, const Params &prms, const CancelFn &cfn, Mat4f *align)
+{
+    const MaskPtr mdata = maskData();
+    assert( mdata->mask);
+    if ( !mdata->mask)
+    {
+        std::cerr << "[ERROR] FaceTools::Action::MaskRegistration::registerMask: Mask not loaded!" << std::endl;
+        return nullptr;
+    }   // end if
+
+    // Clone the loaded mask
+    r3d::Mesh::Ptr mask = mdata->mask->mesh().deepCopy();
+    const size_t mhash = mdata->hash;
+
+    rNonRigid::Mesh floating;
+    floating.features = mask->toFeatures( floating.topology, true/*use transformed*/);
+    floating.flags = rNonRigid::FlagVec::Ones( floating.features.rows());   // Use all vertices on the mask
+
+    CacheHeader hdr;
+    memcpy( hdr.magic, CACHE_MAGIC, sizeof(hdr.magic));
+    hdr.version = CACHE_VERSION;
+    hdr.nvtxs = uint32_t( mask->numVtxs());
+    hdr.meshHash = hashModel( fm->mesh());
+    hdr.maskHash = mhash;
+    hdr.prmsHash = hashParams( prms);
+    const QString cpath = cacheFilePath( hdr);
+
+    MatX3f vrows;
+    Mat4f T;
+    r3d::Mesh::Ptr cmask;
+    if ( readCache( cpath, hdr, vrows, T))
+    {
+        cmask = r3d::Mesh::fromVertices( vrows);
+        cmask->setFaces( floating.topology);
+    }   // end if
+    else
+    {
+        vrows = registerVertices( fm, prms, *mask, floating, cfn);
+        if ( vrows.rows() == 0)   // Cancelled (the working copy of the mask is discarded)
+            return nullptr;
+        //std::cout << "Creating point cloud from registered vertices..." << std::endl;
+        // Make a new r3d::Mesh object from the surface registered points.
+        cmask = r3d::Mesh::fromVertices( vrows);
+        //std::cout << "Setting mesh topology..." << std::endl;
+        cmask->setFaces( floating.topology);
+        T = calcMaskAlignment( *cmask);
+        writeCache( cpath, hdr, vrows, T);
+    }   // end else
+
+    if ( align)
+        *align = T;
     return cmask;
 }   // end registerMask
 
 
+void MaskRegistration::setCacheDir( const QString &cdir)
+{
+    s_cacheLock.lockForWrite();
+    s_cacheDir = cdir;
+    s_cacheDirSet = true;
+    s_cacheLock.unlock();
+}   // end setCacheDir
+
+
+QString MaskRegistration::cacheDir()
+{
+    s_cacheLock.lockForRead();
+    const QString cdir = s_cacheDirSet ? s_cacheDir
+                       : QDir( QStandardPaths::writableLocation( QStandardPaths::CacheLocation)).filePath( "registrations");
+    s_cacheLock.unlock();
+    return cdir;
+}   // end cacheDir
+
+
+void MaskRegistration::setCacheLimit( qint64 nbytes)
+{
+    s_cacheLock.lockForWrite();
+    s_cacheLimit = nbytes;
+    s_cacheLock.unlock();
+}   // end setCacheLimit
+
+
+qint64 MaskRegistration::cacheLimit()
+{
+    s_cacheLock.lockForRead();
+    const qint64 nbytes = s_cacheLimit;
+    s_cacheLock.unlock();
+    return nbytes;
+}   // end cacheLimit
+
+
+void MaskRegistration::clearCache()
+{
+    const QString cdir = cacheDir();
+    if ( cdir.isEmpty())
+        return;
+    QDir dir( cdir);
+    for ( const QString &fname : dir.entryList( QStringList() << "*.reg", QDir::Files))
+        dir.remove( fname);
+}   // end clearCache
+
+
 r3d::Mat4f MaskRegistration::calcMaskAlignment( const r3d::Mesh &mask)
 {
     const MaskPtr mdata = maskData();
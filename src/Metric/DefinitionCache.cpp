@@ -0,0 +1,150 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <Metric/DefinitionCache.h>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QDir>
+#include <iostream>
+using FaceTools::Metric::DefinitionCache;
+
+// Static definitions
+QString DefinitionCache::s_cacheDir;
+bool DefinitionCache::s_cacheDirSet(false);
+std::unordered_map<QString, QByteArray> DefinitionCache::s_keys;
+
+namespace {
+static const quint32 MAGIC = 0x46544443; // "FTDC"
+static const int STREAM_VERSION = QDataStream::Qt_5_9;
+}   // end namespace
+
+
+void DefinitionCache::setCacheDir( const QString &cdir)
+{
+    s_cacheDir = cdir;
+    s_cacheDirSet = true;
+}   // end setCacheDir
+
+
+QString DefinitionCache::cacheDir()
+{
+    return s_cacheDirSet ? s_cacheDir
+         : QDir( QStandardPaths::writableLocation( QStandardPaths::CacheLocation)).filePath( "definitions");
+}   // end cacheDir
+
+
+void DefinitionCache::clearCache()
+{
+    const QString cdir = cacheDir();
+    if ( cdir.isEmpty())
+        return;
+    QDir dir( cdir);
+    for ( const QString &fname : dir.entryList( QStringList() << "*.snapshot", QDir::Files))
+        dir.remove( fname);
+}   // end clearCache
+
+
+QByteArray DefinitionCache::key( const QString &name)
+{
+    return s_keys.count(name) > 0 ? s_keys.at(name) : QByteArray();
+}   // end key
+
+
+DefinitionCache::DefinitionCache( const QString &name, const QStringList &fpaths, const QByteArray &salt)
+{
+    s_keys[name].clear();
+    const QString cdir = cacheDir();
+    if ( cdir.isEmpty())
+        return;
+
+    QCryptographicHash hash( QCryptographicHash::Sha1);
+    const quint32 version = VERSION;
+    hash.addData( reinterpret_cast<const char*>(&version), sizeof(version));
+    hash.addData( salt);
+    for ( const QString &fpath : fpaths)
+    {
+        QFile file( fpath);
+        if ( !file.open( QIODevice::ReadOnly))
+        {
+            std::cerr << "[WARN] FaceTools::Metric::DefinitionCache: Unable to read " << fpath.toStdString() << std::endl;
+            return;
+        }   // end if
+        hash.addData( QFileInfo( fpath).fileName().toUtf8());
+        hash.addData( &file);
+    }   // end for
+
+    _key = hash.result();
+    s_keys[name] = _key;
+    _fpath = QDir( cdir).filePath( name + ".snapshot");
+}   // end ctor
+
+
+QDataStream* DefinitionCache::read()
+{
+    if ( _fpath.isEmpty())
+        return nullptr;
+
+    _rfile.setFileName( _fpath);
+    if ( !_rfile.open( QIODevice::ReadOnly))
+        return nullptr;
+
+    _stream.setDevice( &_rfile);
+    _stream.setVersion( STREAM_VERSION);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray key;
+    _stream >> magic >> version >> key;
+    if ( _stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION || key != _key)
+    {
+        _stream.setDevice( nullptr);
+        _rfile.close();
+        return nullptr;
+    }   // end if
+
+    return &_stream;
+}   // end read
+
+
+QDataStream* DefinitionCache::write()
+{
+    if ( _fpath.isEmpty() || !QDir().mkpath( QFileInfo( _fpath).absolutePath()))
+        return nullptr;
+
+    _rfile.close();
+    _wfile.setFileName( _fpath);
+    if ( !_wfile.open( QIODevice::WriteOnly))
+        return nullptr;
+
+    _stream.setDevice( &_wfile);
+    _stream.setVersion( STREAM_VERSION);
+    _stream.resetStatus();
+    _stream << MAGIC << VERSION << _key;
+    return &_stream;
+}   // end write
+
+
+bool DefinitionCache::commit()
+{
+    if ( !_wfile.isOpen())
+        return false;
+    const bool ok = _stream.status() == QDataStream::Ok && _wfile.commit();
+    _stream.setDevice( nullptr);
+    if ( !ok)
+        std::cerr << "[WARN] FaceTools::Metric::DefinitionCache::commit: Unable to write " << _fpath.toStdString() << std::endl;
+    return ok;
+}   // end commit
@@ -35,11 +35,27 @@ GrowthData::Ptr GrowthData::create( int mid, size_t ndims, int8_t sex, int ethn)
 
 // private
 GrowthData::GrowthData( int mid, size_t ndims, int8_t sex, int ethn)
-    : _id(-1), _mid(mid), _sex(sex), _ethn(ethn), _n(0), _inplane(false), _rsds(ndims)
+    : _id(-1), _mid(mid), _sex(sex), _ethn(ethn), _n(0), _inplane(false), _rsds(ndims), _tables(ndims)
 {
 }   // end ctor
 
 
+void GrowthData::setRSD( size_t d, const rlib::RSD::Ptr &rsd)
+{
+    _rsds[d] = rsd;
+    _tables[d] = GrowthTable( rsd.get());
+#ifndef NDEBUG
+    static const float MAX_ZSCORE_ERROR = 1e-3f;
+    const float err = rsd ? _tables[d].maxError( *rsd) : 0.0f;
+    if ( err > MAX_ZSCORE_ERROR)
+    {
+        std::cerr << "[WARN] FaceTools::Metric::GrowthData::setRSD: Z-score lookup error of " << err
+                  << " for dimension " << d << " of metric " << _mid << std::endl;
+    }   // end if
+#endif
+}   // end setRSD
+
+
 void GrowthData::setSource( const QString& s)
 {
     _source = s;
@@ -194,9 +210,6 @@ GrowthData::Ptr GrowthData::create( const std::vector<const GrowthData*>& gds)
     gc->setN( std::max( 0, nsmps));
     gc->setInPlane( inplane);
     // Combine the distributions over each dimension
-    std::vector<rlib::RSD::Ptr>& nrsds = gc->_rsds;
-    nrsds.resize(nd);
-
     for ( size_t d = 0; d < nd; ++d)
     {
         float tmin = -FLT_MAX;
@@ -212,7 +225,7 @@ GrowthData::Ptr GrowthData::create( const std::vector<const GrowthData*>& gds)
         }   // end for
         std::vector<double> trng;
         createAgeRange( trng, tmin, tmax);
-        nrsds[d] = rlib::RSD::average( trng, drsds);
+        gc->setRSD( d, rlib::RSD::average( trng, drsds));
     }   // end for
 
     return gc;
@@ -414,3 +427,83 @@ bool GrowthData::load( const QString &fpath)
 
     return true;
 }   // end load
+
+
+void GrowthData::write( QDataStream &os) const
+{
+    // Temporary mixed ethnicity codes are made at runtime so store their components instead.
+    QList<qint32> ecodes;
+    if ( _ethn < 0)
+        for ( int c : Ethnicities::childCodes( _ethn))
+            ecodes << c;
+    else
+        ecodes << _ethn;
+
+    os << qint32(_mid) << quint32(_rsds.size()) << qint8(_sex) << ecodes << qint32(_n) << _inplane
+       << _source << _note << _lnote;
+
+    for ( const rlib::RSD::Ptr &rsd : _rsds)
+    {
+        os << bool(rsd);
+        if ( !rsd)
+            continue;
+        const Vec_3DP &dvec = rsd->data();
+        os << quint32(dvec.size());
+        for ( const auto &dp : dvec)
+            os << double(dp[0]) << double(dp[1]) << double(dp[2]);
+    }   // end for
+}   // end write
+
+
+GrowthData::Ptr GrowthData::read( QDataStream &is)
+{
+    qint32 mid, n;
+    quint32 ndims;
+    qint8 sex;
+    QList<qint32> ecodes;
+    bool inplane;
+    QString source, note, lnote;
+    is >> mid >> ndims >> sex >> ecodes >> n >> inplane >> source >> note >> lnote;
+    if ( is.status() != QDataStream::Ok || ecodes.isEmpty())
+        return nullptr;
+
+    int ethn = ecodes.front();
+    if ( ecodes.size() > 1)
+    {
+        IntSet eset;
+        for ( int c : ecodes)
+            eset.insert(c);
+        ethn = Ethnicities::codeMix( eset);
+        if ( ethn == 0)
+            ethn = Ethnicities::makeMixedCode( eset);
+    }   // end if
+
+    GrowthData::Ptr gd = create( mid, ndims, int8_t(sex), ethn);
+    gd->_n = n;
+    gd->_inplane = inplane;
+    gd->_source = source;
+    gd->_note = note;
+    gd->_lnote = lnote;
+
+    for ( size_t d = 0; d < ndims; ++d)
+    {
+        bool hasRSD = false;
+        is >> hasRSD;
+        if ( !hasRSD)
+            continue;
+        quint32 npts = 0;
+        is >> npts;
+        if ( is.status() != QDataStream::Ok)
+            return nullptr;
+        Vec_3DP dvec;
+        for ( quint32 k = 0; k < npts; ++k)
+        {
+            double t, y, z;
+            is >> t >> y >> z;
+            dvec.push_back( {t,y,z});
+        }   // end for
+        gd->setRSD( d, rlib::RSD::create( dvec));
+    }   // end for
+
+    return is.status() == QDataStream::Ok ? gd : nullptr;
+}   // end read
@@ -0,0 +1,120 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <Metric/GrowthTable.h>
+#include <cmath>
+using FaceTools::Metric::GrowthTable;
+
+
+GrowthTable::GrowthTable() : _t0(0), _t1(0), _ipy(0), _last(0) {}
+
+
+GrowthTable::GrowthTable( const rlib::RSD *rsd) : GrowthTable()
+{
+    if ( !rsd)
+        return;
+
+    // Same domain that MetricValue has always clamped ages to before z-scoring.
+    _t0 = float(rsd->tmin());
+    _t1 = std::max<float>( _t0, float( int(rsd->tmax() + 0.5)));
+
+    const int n = std::max( 2, int( std::ceil( (_t1 - _t0) * STEPS_PER_YEAR)) + 1);
+    _last = n - 2;
+    _ipy = _t1 > _t0 ? float(n - 1) / (_t1 - _t0) : 0.0f;
+
+    _mean.resize( size_t(n));
+    _sd.resize( size_t(n));
+    for ( int k = 0; k < n; ++k)
+    {
+        const double t = double(_t0) + (double(_t1) - double(_t0)) * k / (n - 1);
+        _mean[size_t(k)] = float( rsd->mval( t));
+        _sd[size_t(k)] = float( rsd->zval( t));
+    }   // end for
+}   // end ctor
+
+
+float GrowthTable::mean( float age) const
+{
+    int i;
+    float f;
+    _index( age, i, f);
+    return _mean[i] + f * (_mean[i+1] - _mean[i]);
+}   // end mean
+
+
+float GrowthTable::sd( float age) const
+{
+    int i;
+    float f;
+    _index( age, i, f);
+    return _sd[i] + f * (_sd[i+1] - _sd[i]);
+}   // end sd
+
+
+float GrowthTable::zscore( float age, float v) const
+{
+    int i;
+    float f;
+    _index( age, i, f);
+    const float m = _mean[i] + f * (_mean[i+1] - _mean[i]);
+    const float s = _sd[i] + f * (_sd[i+1] - _sd[i]);
+    return (v - m) / s;
+}   // end zscore
+
+
+void GrowthTable::zscores( size_t n, const float *ages, const float *vals, float *zs) const
+{
+    const float *mn = _mean.data();
+    const float *sd = _sd.data();
+    for ( size_t k = 0; k < n; ++k)
+    {
+        int i;
+        float f;
+        _index( ages[k], i, f);
+        const float m = mn[i] + f * (mn[i+1] - mn[i]);
+        const float s = sd[i] + f * (sd[i+1] - sd[i]);
+        zs[k] = (vals[k] - m) / s;
+    }   // end for
+}   // end zscores
+
+
+void GrowthTable::zscores( size_t n, float age, const float *vals, float *zs) const
+{
+    // Mean and standard deviation are the same for every value so this vectorises fully.
+    const float m = mean( age);
+    const float s = sd( age);
+    for ( size_t k = 0; k < n; ++k)
+        zs[k] = (vals[k] - m) / s;
+}   // end zscores
+
+
+float GrowthTable::maxError( const rlib::RSD &rsd) const
+{
+    float maxErr = 0;
+    if ( empty())
+        return maxErr;
+    const int nq = 2*_last + 3;  // Sample ages and the midpoints between them
+    const double dt = _ipy > 0 ? 0.5 / _ipy : 0.0;
+    for ( int k = 0; k < nq; ++k)
+    {
+        const double t = std::min<double>( _t1, _t0 + k * dt);
+        const double v = rsd.mval( t) + 2 * rsd.zval( t);
+        const float err = float( std::fabs( zscore( float(t), float(v)) - rsd.zscore( t, v)));
+        maxErr = std::max( maxErr, err);
+    }   // end for
+    return maxErr;
+}   // end maxError
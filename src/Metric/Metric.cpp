@@ -28,80 +28,85 @@ using FaceTools::Metric::MetricSet;
 using FaceTools::FM;
 
 
+namespace {
+static const std::string WSTR = "[WARN] FaceTools::Metric::Metric::load: ";
+}   // end namespace
+
+
 Metric::Ptr Metric::load( const QString &fpath)
 {
-    static const std::string WSTR = "[WARN] FaceTools::Metric::Metric::load: ";
+    MetricDefinition mdef;
+    return parse( fpath, mdef) ? create( mdef) : nullptr;
+}   // end load
+
+
+bool Metric::parse( const QString &fpath, MetricDefinition &mdef)
+{
     sol::state lua;
     lua.open_libraries( sol::lib::base);
 
-    Metric::Ptr mc;
     try
     {
         lua.script_file( fpath.toStdString());
-        mc = Ptr( new Metric, [](Metric* d){ delete d;});
     }   // end try
     catch ( const sol::error& e)
     {
         std::cerr << WSTR << "Unable to load and execute file '" << fpath.toStdString() << "'!" << std::endl;
         std::cerr << "\t" << e.what() << std::endl;
+        return false;
     }   // end catch
 
-    if ( !mc)
-        return nullptr;
-
     const sol::table table = lua["mc"];
     if ( !table.valid())
     {
         std::cerr << WSTR << "Lua file has no global member named mc!" << std::endl;
-        return nullptr;
+        return false;
     }   // end if
 
-    MetricParams mprms;
-    mprms.id = table["id"].get_or(-1);
-    if ( sol::optional<std::string> v = table["name"]) mc->_name = QString::fromStdString( v.value());
-    if ( sol::optional<std::string> v = table["desc"]) mc->_desc = QString::fromStdString( v.value());
-    if ( sol::optional<std::string> v = table["regn"]) mc->_regn = QString::fromStdString( v.value());
-    mc->_ndps = static_cast<size_t>( table["ndps"].get_or(0));
+    mdef.id = table["id"].get_or(-1);
+    if ( sol::optional<std::string> v = table["name"]) mdef.name = QString::fromStdString( v.value());
+    if ( sol::optional<std::string> v = table["desc"]) mdef.desc = QString::fromStdString( v.value());
+    if ( sol::optional<std::string> v = table["regn"]) mdef.regn = QString::fromStdString( v.value());
+    mdef.ndps = static_cast<size_t>( table["ndps"].get_or(0));
 
-    if ( mprms.id < 0 || mc->_name.isEmpty() || mc->_regn.isEmpty() || mc->_desc.isEmpty())
+    if ( mdef.id < 0 || mdef.name.isEmpty() || mdef.regn.isEmpty() || mdef.desc.isEmpty())
     {
         std::cerr << WSTR << "incomplete metric metadata!" << std::endl;
-        return nullptr;
+        return false;
     }   // end if
 
     const sol::table prms = table["prms"];
     if ( !prms.valid())
     {
         std::cerr << WSTR << "Lua defined metric has no table named prms!" << std::endl;
-        return nullptr;
+        return false;
     }   // end if
 
-    QString catg;
-    if ( sol::optional<std::string> v = prms["catg"]) catg = QString::fromStdString( v.value());
-    if ( sol::optional<std::string> v = prms["norm"]) mprms.normal = QString::fromStdString( v.value()).toLower();
-    if ( sol::optional<std::string> v = prms["rmks"]) mprms.remarks = QString::fromStdString( v.value());
-    mprms.bilateral = prms["blat"].get_or(false);
+    if ( sol::optional<std::string> v = prms["catg"]) mdef.catg = QString::fromStdString( v.value());
+    if ( sol::optional<std::string> v = prms["norm"]) mdef.norm = QString::fromStdString( v.value()).toLower();
+    if ( sol::optional<std::string> v = prms["rmks"]) mdef.rmks = QString::fromStdString( v.value());
+    mdef.blat = prms["blat"].get_or(false);
 
-    if ( catg.isEmpty() || mprms.normal.isEmpty())
+    if ( mdef.catg.isEmpty() || mdef.norm.isEmpty())
     {
         std::cerr << WSTR << "incomplete metric parameters!" << std::endl;
-        return nullptr;
+        return false;
     }   // end if
 
     const sol::table pnts = prms["pnts"];
     if ( !pnts.valid())
     {
         std::cerr << WSTR << "prms table of metric has no table named pnts!" << std::endl;
-        return nullptr;
+        return false;
     }   // end if
 
-    mprms.points.resize( pnts.size());
-    for ( size_t i = 1; i <= pnts.size(); ++i) // Set landmarks defining the metric for each dimension i
+    mdef.pnts.resize( pnts.size());
+    for ( size_t i = 1; i <= pnts.size(); ++i) // Get landmarks defining the metric for each dimension i
     {
         if ( !pnts[i].valid())
         {
             std::cerr << WSTR << "pnts has no dimension table at position " << i << std::endl;
-            return nullptr;
+            return false;
         }   // end if
 
         // The list of points for each dimension is comprised of a table for each point
@@ -109,17 +114,46 @@ Metric::Ptr Metric::load( const QString &fpath)
         // codes of several landmarks.
 
         const sol::table dpts = pnts[i];    // List of points for dimension i
-        std::vector<Landmark::LmkList> &pts = mprms.points[i-1];
+        std::vector< std::vector<QString> > &pts = mdef.pnts[i-1];
         pts.resize(dpts.size());
         for ( size_t j = 1; j <= dpts.size(); ++j)   // For each point (which IS a landmark list)
         {
             const sol::table ptj = dpts[j];
-            std::vector<QString> lmks( ptj.size());
+            std::vector<QString> &lmks = pts[j-1];
+            lmks.resize( ptj.size());
             for ( size_t k = 1; k <= ptj.size(); ++k)    // For each landmark code in the point
                 if ( sol::optional<std::string> v = ptj[k])
                     lmks[k-1] = QString::fromStdString( v.value());
+        }   // end for
+    }   // end for
+
+    return true;
+}   // end parse
+
 
-            if ( Landmark::fromParams( lmks, pts[j-1]) <= 0)
+Metric::Ptr Metric::create( const MetricDefinition &mdef)
+{
+    Metric::Ptr mc( new Metric, [](Metric* d){ delete d;});
+    mc->_name = mdef.name;
+    mc->_desc = mdef.desc;
+    mc->_regn = mdef.regn;
+    mc->_ndps = mdef.ndps;
+
+    MetricParams mprms;
+    mprms.id = mdef.id;
+    mprms.normal = mdef.norm;
+    mprms.remarks = mdef.rmks;
+    mprms.bilateral = mdef.blat;
+
+    mprms.points.resize( mdef.pnts.size());
+    for ( size_t i = 0; i < mdef.pnts.size(); ++i)
+    {
+        const std::vector< std::vector<QString> > &dpts = mdef.pnts[i];
+        std::vector<Landmark::LmkList> &pts = mprms.points[i];
+        pts.resize( dpts.size());
+        for ( size_t j = 0; j < dpts.size(); ++j)
+        {
+            if ( Landmark::fromParams( dpts[j], pts[j]) <= 0)
             {
                 std::cerr << WSTR << "no landmarks read in for points list!" << std::endl;
                 return nullptr;
@@ -127,7 +161,7 @@ Metric::Ptr Metric::load( const QString &fpath)
         }   // end for
     }   // end for
 
-    mc->_mct = MetricTypeRegistry::make( catg, mprms);
+    mc->_mct = MetricTypeRegistry::make( mdef.catg, mprms);
     if ( !mc->_mct)
     {
         std::cerr << WSTR << "Invalid metric category" << std::endl;
@@ -135,7 +169,47 @@ Metric::Ptr Metric::load( const QString &fpath)
     }   // end if
 
     return mc;
-}   // end load
+}   // end create
+
+
+QDataStream& FaceTools::Metric::operator<<( QDataStream &os, const MetricDefinition &mdef)
+{
+    os << qint32(mdef.id) << mdef.name << mdef.desc << mdef.regn << quint32(mdef.ndps)
+       << mdef.catg << mdef.norm << mdef.rmks << mdef.blat;
+    os << quint32(mdef.pnts.size());
+    for ( const auto &dpts : mdef.pnts)
+    {
+        os << quint32(dpts.size());
+        for ( const std::vector<QString> &lmks : dpts)
+            os << QStringList( lmks.begin(), lmks.end());
+    }   // end for
+    return os;
+}   // end operator<<
+
+
+QDataStream& FaceTools::Metric::operator>>( QDataStream &is, MetricDefinition &mdef)
+{
+    qint32 id;
+    quint32 ndps, ndims;
+    is >> id >> mdef.name >> mdef.desc >> mdef.regn >> ndps
+       >> mdef.catg >> mdef.norm >> mdef.rmks >> mdef.blat >> ndims;
+    mdef.id = id;
+    mdef.ndps = ndps;
+    mdef.pnts.resize( is.status() == QDataStream::Ok ? ndims : 0);
+    for ( auto &dpts : mdef.pnts)
+    {
+        quint32 npts = 0;
+        is >> npts;
+        dpts.resize( is.status() == QDataStream::Ok ? npts : 0);
+        for ( std::vector<QString> &lmks : dpts)
+        {
+            QStringList codes;
+            is >> codes;
+            lmks = std::vector<QString>( codes.begin(), codes.end());
+        }   // end for
+    }   // end for
+    return is;
+}   // end operator>>
 
 
 Metric::Metric() : _visible(false), _ndps(0) {}
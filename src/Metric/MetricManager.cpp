@@ -16,6 +16,7 @@
  ************************************************************************/
 
 #include <Metric/MetricManager.h>
+#include <Metric/DefinitionCache.h>
 #include <QDir>
 #include <QFile>
 #include <QTextStream>
@@ -25,6 +26,8 @@
 using FaceTools::Metric::MetricManager;
 using FaceTools::Metric::MCSet;
 using FaceTools::Metric::MC;
+using FaceTools::Metric::MetricDefinition;
+using FaceTools::Metric::DefinitionCache;
 using FaceTools::FM;
 
 // Static definitions
@@ -57,11 +60,47 @@ int MetricManager::load( const QString& dname)
         return -1;
     }   // end if
 
-    int nloaded = 0;
     const QStringList fnames = mdir.entryList( QDir::Files | QDir::Readable, QDir::Type | QDir::Name);
+    QStringList fpaths;
     for ( const QString& fname : fnames)
+        fpaths << mdir.absoluteFilePath(fname);
+
+    // Restore the parsed definitions from the snapshot unless the files have changed since it was made.
+    std::vector<MetricDefinition> mdefs;
+    DefinitionCache cache( "metrics", fpaths);
+    if ( QDataStream *is = cache.read())
+    {
+        quint32 n = 0;
+        *is >> n;
+        mdefs.resize( is->status() == QDataStream::Ok ? n : 0);
+        for ( MetricDefinition &mdef : mdefs)
+            *is >> mdef;
+        if ( is->status() != QDataStream::Ok)
+            mdefs.clear();
+    }   // end if
+
+    if ( mdefs.empty())
+    {
+        for ( const QString& fpath : fpaths)
+        {
+            MetricDefinition mdef;
+            if ( MC::parse( fpath, mdef))
+                mdefs.push_back( mdef);
+        }   // end for
+
+        if ( QDataStream *os = cache.write())
+        {
+            *os << quint32(mdefs.size());
+            for ( const MetricDefinition &mdef : mdefs)
+                *os << mdef;
+            cache.commit();
+        }   // end if
+    }   // end if
+
+    int nloaded = 0;
+    for ( const MetricDefinition &mdef : mdefs)
     {
-        MC::Ptr mc = MC::load( mdir.absoluteFilePath(fname));
+        MC::Ptr mc = MC::create( mdef);
         if ( !mc)
             continue;
 
@@ -33,10 +33,8 @@ float MetricValue::zscore( float age, size_t i) const
     const GrowthData *gd = MM::metric(_id)->growthData().current();
     if ( gd)
     {
-        rlib::RSD::CPtr rsd = gd->rsd(i);
-        assert(rsd);
-        const double t = std::max<double>( rsd->tmin(), std::min<double>( age, int(rsd->tmax() + 0.5)));
-        zs = float(rsd->zscore( t, _values.at(i)));
+        assert( gd->rsd(i));
+        zs = gd->table(i).zscore( age, _values.at(i));
     }   // end if
     return zs;
 }   // end zscore
@@ -48,10 +46,8 @@ float MetricValue::mean( float age, size_t i) const
     const GrowthData *gd = MM::metric(_id)->growthData().current();
     if ( gd)
     {
-        rlib::RSD::CPtr rsd = gd->rsd(i);
-        assert(rsd);
-        const double t = std::max<double>( rsd->tmin(), std::min<double>( age, int(rsd->tmax() + 0.5)));
-        mn = float(rsd->mval( t));
+        assert( gd->rsd(i));
+        mn = gd->table(i).mean( age);
     }   // end if
     return mn;
 }   // end mean
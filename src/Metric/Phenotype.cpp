@@ -19,6 +19,7 @@
 #include <Metric/MetricManager.h>
 #include <Ethnicities.h>
 #include <FaceModel.h>
+#include <QFile>
 using FaceTools::Metric::Phenotype;
 using FaceTools::Metric::MetricSet;
 using FaceTools::Metric::MetricValue;
@@ -27,46 +28,96 @@ using MM = FaceTools::Metric::MetricManager;
 using FaceTools::FM;
 
 
-// private
-Phenotype::Phenotype() : _id(-1)
+// static definitions
+bool Phenotype::s_useCompiled(true);
+
+
+namespace {
+
+// Returns the source text of the given function as defined in the given script file (empty if unavailable).
+std::string functionSource( const sol::function &fn, const QString &fpath)
 {
-    // Register MetricSet for Phenotype determination function:
-    _lua.new_usertype<MetricSet>( "MetricSet",
-                                  "metric", &MetricSet::metric);
+    lua_State *L = fn.lua_state();
+    fn.push();
+    lua_Debug ar;
+    if ( !lua_getinfo( L, ">S", &ar) || ar.linedefined <= 0)
+        return "";
+
+    QFile file( fpath);
+    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text))
+        return "";
+    const QStringList lines = QString( file.readAll()).split('\n');
+    if ( ar.lastlinedefined > lines.size())
+        return "";
+
+    const QString src = lines.mid( ar.linedefined-1, ar.lastlinedefined - ar.linedefined + 1).join('\n');
+    const int i0 = src.indexOf("function");
+    const int i1 = src.lastIndexOf("end");
+    if ( i0 < 0 || i1 < i0)
+        return "";
+    return src.mid( i0, i1 + 3 - i0).toStdString();
+}   // end functionSource
+
+}   // end namespace
+
 
-    _lua.new_usertype<MetricValue>( "MetricValue",
-                                    "ndims", &MetricValue::ndims,
-                                    "mean", &MetricValue::mean,
-                                    "value", &MetricValue::value,
-                                    "zscore", &MetricValue::zscore);
-}   // end ctor
+// private
+Phenotype::Phenotype() : _id(-1), _hasDetermine(false), _nevals(0) {}
 
 
 // public static
 Phenotype::Ptr Phenotype::create() { return Ptr( new Phenotype, [](Phenotype *d){ delete d;});}
 
 
-// public static
-Phenotype::Ptr Phenotype::load( const QString& fpath)
+// private static
+std::unique_ptr<Phenotype::Evaluator> Phenotype::_loadEvaluator( const QString& fpath)
 {
-    bool loadedOk = false;
-    Ptr hpo = create();
-    hpo->_lua.open_libraries( sol::lib::base);
+    std::unique_ptr<Evaluator> eval( new Evaluator);
+
+    // Register MetricSet for Phenotype determination function:
+    eval->lua.new_usertype<MetricSet>( "MetricSet",
+                                       "metric", &MetricSet::metric);
+
+    eval->lua.new_usertype<MetricValue>( "MetricValue",
+                                         "ndims", &MetricValue::ndims,
+                                         "mean", &MetricValue::mean,
+                                         "value", &MetricValue::value,
+                                         "zscore", &MetricValue::zscore);
+
+    eval->lua.open_libraries( sol::lib::base);
     try
     {
-        hpo->_lua.script_file( fpath.toStdString());
-        loadedOk = true;
+        eval->lua.script_file( fpath.toStdString());
     }   // end try
     catch ( const sol::error& e)
     {
         std::cerr << "[WARN] FaceTools::Metric::Phenotype::load: Unable to load and execute file '" << fpath.toStdString() << "'!" << std::endl;
         std::cerr << "\t" << e.what() << std::endl;
+        return nullptr;
     }   // end catch
 
-    if ( !loadedOk)
+    auto table = eval->lua["hpo"];
+    if ( table.valid())
+    {
+        if ( sol::optional<sol::function> v = table["determine"])
+            eval->determine = v.value();
+    }   // end if
+
+    return eval;
+}   // end _loadEvaluator
+
+
+// public static
+Phenotype::Ptr Phenotype::load( const QString& fpath)
+{
+    std::unique_ptr<Evaluator> eval = _loadEvaluator( fpath);
+    if ( !eval)
         return nullptr;
 
-    auto table = hpo->_lua["hpo"];
+    Ptr hpo = create();
+    hpo->_fpath = fpath;
+
+    auto table = eval->lua["hpo"];
     if ( !table.valid())
     {
         std::cerr << "[WARN] FaceTools::Metric::Phenotype::load: Missing table 'hpo'!" << std::endl;
@@ -107,13 +158,100 @@ Phenotype::Ptr Phenotype::load( const QString& fpath)
             hpo->_metrics.insert( metrics[i].get_or(-1));
     }   // end if
 
-    if ( sol::optional<sol::function> v = table["determine"])
-        hpo->_determine = v.value();
+    // Compile the criteria natively if possible
+    hpo->_hasDetermine = eval->determine.valid();
+    if ( hpo->_hasDetermine)
+    {
+        std::string err;
+        hpo->_criteria = PhenotypeCriteria::compile( functionSource( eval->determine, fpath), &err);
+#ifndef NDEBUG
+        if ( !hpo->_criteria)
+            std::cerr << "[INFO] FaceTools::Metric::Phenotype::load: Using Lua for HP:" << hpo->_id << " (" << err << ")" << std::endl;
+#endif
+    }   // end if
+
+    // Keep the state the script was loaded into for evaluating the criteria with Lua
+    hpo->_nevals = 1;
+    hpo->_idle.push_back( std::move( eval));
 
     return hpo;
 }   // end load
 
 
+void Phenotype::write( QDataStream &os) const
+{
+    QList<qint32> mids;
+    for ( int mid : _metrics)
+        mids << mid;
+    os << qint32(_id) << _name << _region << _synonyms << _ocriteria << _scriteria << _remarks
+       << _refs << mids << _fpath << _hasDetermine
+       << QByteArray::fromStdString( _criteria ? _criteria->source() : std::string());
+}   // end write
+
+
+Phenotype::Ptr Phenotype::read( QDataStream &is)
+{
+    Ptr hpo = create();
+    qint32 id;
+    QList<qint32> mids;
+    QByteArray csrc;
+    is >> id >> hpo->_name >> hpo->_region >> hpo->_synonyms >> hpo->_ocriteria >> hpo->_scriteria
+       >> hpo->_remarks >> hpo->_refs >> mids >> hpo->_fpath >> hpo->_hasDetermine >> csrc;
+    if ( is.status() != QDataStream::Ok)
+        return nullptr;
+
+    hpo->_id = id;
+    for ( int mid : mids)
+        hpo->_metrics.insert( mid);
+    if ( !csrc.isEmpty())
+        hpo->_criteria = PhenotypeCriteria::compile( csrc.toStdString());
+    return hpo;
+}   // end read
+
+
+std::unique_ptr<Phenotype::Evaluator> Phenotype::_acquire() const
+{
+    std::unique_ptr<Evaluator> eval;
+    _elock.lock();
+    if ( !_idle.empty())
+    {
+        eval = std::move( _idle.back());
+        _idle.pop_back();
+    }   // end if
+    _elock.unlock();
+
+    if ( !eval) // All in use so load another
+    {
+        eval = _loadEvaluator( _fpath);
+        if ( eval)
+        {
+            _elock.lock();
+            _nevals++;
+            _elock.unlock();
+        }   // end if
+    }   // end if
+
+    return eval;
+}   // end _acquire
+
+
+void Phenotype::_release( std::unique_ptr<Evaluator> eval) const
+{
+    _elock.lock();
+    _idle.push_back( std::move( eval));
+    _elock.unlock();
+}   // end _release
+
+
+size_t Phenotype::numEvaluators() const
+{
+    _elock.lock();
+    const size_t n = _nevals;
+    _elock.unlock();
+    return n;
+}   // end numEvaluators
+
+
 bool Phenotype::_hasMeasurements( const FM* fm, int aid) const
 {
     FaceAssessment::CPtr ass = aid < 0 ? fm->currentAssessment() : fm->assessment(aid);
@@ -145,12 +283,25 @@ bool Phenotype::_hasMeasurements( const FM* fm, int aid) const
 
 bool Phenotype::isPresent( const FM* fm, int aid) const
 {
-    if ( !_determine.valid())
+    if ( !_hasDetermine)
         return false;
 
     if ( !_hasMeasurements(fm, aid))
         return false;
 
+    if ( _criteria && s_useCompiled)
+    {
+        FaceAssessment::CPtr ass = aid < 0 ? fm->currentAssessment() : fm->assessment(aid);
+        return _criteria->evaluate( fm->age(), ass->cmetrics(MID), ass->cmetrics(LEFT), ass->cmetrics(RIGHT));
+    }   // end if
+
+    std::unique_ptr<Evaluator> eval = _acquire();
+    if ( !eval || !eval->determine.valid())
+    {
+        std::cerr << "[WARN] FaceTools::Metric::Phenotype::isPresent: Unable to reload determination script!" << std::endl;
+        return false;
+    }   // end if
+
     bool present = false;
     try
     {
@@ -158,7 +309,7 @@ bool Phenotype::isPresent( const FM* fm, int aid) const
         const MetricSet& mlat = ass->cmetrics(MID);
         const MetricSet& llat = ass->cmetrics(LEFT);
         const MetricSet& rlat = ass->cmetrics(RIGHT);
-        sol::function_result result = _determine( fm->age(), mlat, llat, rlat);
+        sol::function_result result = eval->determine( fm->age(), mlat, llat, rlat);
         if ( result.valid())
             present = result;
         else
@@ -169,6 +320,7 @@ bool Phenotype::isPresent( const FM* fm, int aid) const
         std::cerr << "[WARN] FaceTools::Metric::Phenotype::isPresent: Error in determination script!" << std::endl;
         std::cerr << "\t" << e.what() << std::endl;
     }   // end catch
+    _release( std::move( eval));
 
     /*
     if ( present)
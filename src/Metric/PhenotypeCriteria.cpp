@@ -0,0 +1,670 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <Metric/PhenotypeCriteria.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <cctype>
+#include <cstdlib>
+using FaceTools::Metric::PhenotypeCriteria;
+using FaceTools::Metric::MetricSet;
+using FaceTools::Metric::MetricValue;
+
+
+namespace {
+
+struct Token
+{
+    enum Type { NAME, NUMBER, SYM, END};
+    Type type;
+    std::string s;
+    double num;
+};  // end struct
+
+
+const std::unordered_set<std::string> KEYWORDS = { "and", "break", "do", "else", "elseif", "end", "false", "for",
+    "function", "goto", "if", "in", "local", "nil", "not", "or", "repeat", "return", "then", "true", "until", "while"};
+
+
+// Split the source into tokens returning false (with err set) on anything not expressible.
+bool tokenize( const std::string &src, std::vector<Token> &toks, std::string &err)
+{
+    const size_t n = src.size();
+    size_t i = 0;
+    while ( i < n)
+    {
+        const char c = src[i];
+        if ( isspace(c))
+            ++i;
+        else if ( src.compare( i, 2, "--") == 0)  // Comment
+        {
+            if ( src.compare( i, 4, "--[[") == 0)
+            {
+                const size_t j = src.find( "]]", i+4);
+                if ( j == std::string::npos)
+                {
+                    err = "Unterminated block comment";
+                    return false;
+                }   // end if
+                i = j + 2;
+            }   // end if
+            else
+            {
+                while ( i < n && src[i] != '\n')
+                    ++i;
+            }   // end else
+        }   // end else if
+        else if ( isalpha(c) || c == '_')
+        {
+            size_t j = i+1;
+            while ( j < n && (isalnum(src[j]) || src[j] == '_'))
+                ++j;
+            toks.push_back( {Token::NAME, src.substr( i, j-i), 0.0});
+            i = j;
+        }   // end else if
+        else if ( isdigit(c) || (c == '.' && i+1 < n && isdigit(src[i+1])))
+        {
+            if ( src.compare( i, 2, "0x") == 0 || src.compare( i, 2, "0X") == 0)
+            {
+                err = "Hexadecimal numbers not supported";
+                return false;
+            }   // end if
+            char *e = nullptr;
+            const double v = strtod( src.c_str() + i, &e);
+            const size_t j = size_t( e - src.c_str());
+            toks.push_back( {Token::NUMBER, src.substr( i, j-i), v});
+            i = j;
+        }   // end else if
+        else
+        {
+            static const std::string SYM2[] = {"<=", ">=", "==", "~="};
+            static const std::string SYM1 = "(),:+-*/<>=;";
+            std::string sym;
+            for ( const std::string &s : SYM2)
+                if ( src.compare( i, 2, s) == 0)
+                    sym = s;
+            if ( sym.empty() && SYM1.find(c) != std::string::npos)
+                sym = std::string( 1, c);
+            if ( sym.empty())
+            {
+                err = std::string("Unsupported symbol '") + c + "'";
+                return false;
+            }   // end if
+            toks.push_back( {Token::SYM, sym, 0.0});
+            i += sym.size();
+        }   // end else
+    }   // end while
+    toks.push_back( {Token::END, "", 0.0});
+    return true;
+}   // end tokenize
+
+}   // end namespace
+
+
+namespace FaceTools { namespace Metric {
+
+// Recursive descent compiler of the tokens to the criteria's program.
+class CriteriaCompiler
+{
+public:
+    CriteriaCompiler( const std::vector<Token> &toks, PhenotypeCriteria &pc)
+        : _toks(toks), _pos(0), _pc(pc), _depth(0), _nparams(0), _mset(-1), _mid(-1) {}
+
+    bool compile();
+
+    const std::string& error() const { return _err;}
+
+private:
+    enum Type { NUM, BOOL, METRIC};
+
+    struct Local
+    {
+        Type type;
+        int idx;    // Index of value (NUM or BOOL)
+        int set;    // Metric set (METRIC)
+        int mid;    // Metric ID (METRIC)
+    };  // end struct
+
+    const std::vector<Token> &_toks;
+    size_t _pos;
+    PhenotypeCriteria &_pc;
+    int _depth;
+    std::string _err;
+    std::string _params[4];     // Age then the mid, left and right sets
+    int _nparams;
+    std::unordered_map<std::string, Local> _locals;
+    int _mset;  // Set and ID of the last metric parsed
+    int _mid;
+
+    const Token& _peek() const { return _toks[_pos];}
+
+    bool _isSym( const char *s) const { return _peek().type == Token::SYM && _peek().s == s;}
+    bool _isName( const char *s) const { return _peek().type == Token::NAME && _peek().s == s;}
+
+    bool _accept( const char *s)
+    {
+        if ( _isSym(s) || _isName(s))
+        {
+            _pos++;
+            return true;
+        }   // end if
+        return false;
+    }   // end _accept
+
+    bool _expect( const char *s)
+    {
+        if ( _accept(s))
+            return true;
+        return _fail( std::string("Expected '") + s + "' but found '" + _peek().s + "'");
+    }   // end _expect
+
+    bool _fail( const std::string &err)
+    {
+        if ( _err.empty())
+            _err = err;
+        return false;
+    }   // end _fail
+
+    bool _name( std::string &nm)
+    {
+        if ( _peek().type != Token::NAME || KEYWORDS.count( _peek().s) > 0)
+            return _fail( "Expected name but found '" + _peek().s + "'");
+        nm = _toks[_pos++].s;
+        return true;
+    }   // end _name
+
+    bool _integer( int &v)
+    {
+        if ( _peek().type != Token::NUMBER || _peek().num < 0 || _peek().num != double(int(_peek().num)))
+            return _fail( "Expected non-negative integer but found '" + _peek().s + "'");
+        v = int( _toks[_pos++].num);
+        return true;
+    }   // end _integer
+
+    size_t _emit( PhenotypeCriteria::Op op, int set=0, int id=0, int dim=0, double val=0.0)
+    {
+        switch ( op)
+        {
+            case PhenotypeCriteria::CONST:
+            case PhenotypeCriteria::AGE:
+            case PhenotypeCriteria::LOAD:
+            case PhenotypeCriteria::VALUE:
+            case PhenotypeCriteria::NDIMS:
+                _depth++;
+                break;
+            case PhenotypeCriteria::STORE:
+            case PhenotypeCriteria::ADD:
+            case PhenotypeCriteria::SUB:
+            case PhenotypeCriteria::MUL:
+            case PhenotypeCriteria::DIV:
+            case PhenotypeCriteria::LT:
+            case PhenotypeCriteria::LE:
+            case PhenotypeCriteria::GT:
+            case PhenotypeCriteria::GE:
+            case PhenotypeCriteria::EQ:
+            case PhenotypeCriteria::NE:
+            case PhenotypeCriteria::POP:
+                _depth--;
+                break;
+            default:
+                break;
+        }   // end switch
+        if ( _depth > PhenotypeCriteria::MAX_STACK)
+            _fail( "Expression too deep");
+        _pc._code.push_back( {op, set, id, dim, val});
+        return _pc._code.size() - 1;
+    }   // end _emit
+
+    bool _or( Type&);
+    bool _and( Type&);
+    bool _compare( Type&);
+    bool _add( Type&);
+    bool _mul( Type&);
+    bool _unary( Type&);
+    bool _primary( Type&);
+    bool _method( int set, int mid, Type&);
+};  // end class
+
+
+bool CriteriaCompiler::compile()
+{
+    if ( !_expect("function") || !_expect("("))
+        return false;
+    _nparams = 0;
+    if ( !_isSym(")"))
+    {
+        do
+        {
+            if ( _nparams == 4)
+                return _fail( "Too many parameters");
+            if ( !_name( _params[_nparams++]))
+                return false;
+        } while ( _accept(","));
+    }   // end if
+    if ( !_expect(")"))
+        return false;
+
+    while ( _accept("local"))
+    {
+        std::string nm;
+        Type t;
+        if ( !_name( nm) || !_expect("=") || !_or( t))
+            return false;
+        if ( t == METRIC)   // Metrics are aliased at compile time
+            _locals[nm] = {METRIC, -1, _mset, _mid};
+        else
+        {
+            if ( _pc._nlocals == PhenotypeCriteria::MAX_LOCALS)
+                return _fail( "Too many locals");
+            const int idx = _pc._nlocals++;
+            _emit( PhenotypeCriteria::STORE, 0, idx);
+            _locals[nm] = {t, idx, 0, 0};
+        }   // end else
+        _accept(";");
+    }   // end while
+
+    Type t;
+    if ( !_expect("return") || !_or( t))
+        return false;
+    if ( t != BOOL)
+        return _fail( "Function must return a boolean expression");
+    _accept(";");
+    if ( !_expect("end"))
+        return false;
+    if ( _peek().type != Token::END)
+        return _fail( "Unexpected '" + _peek().s + "' after function");
+    return _err.empty();
+}   // end compile
+
+
+bool CriteriaCompiler::_or( Type &t)
+{
+    if ( !_and( t))
+        return false;
+    while ( _accept("or"))
+    {
+        const size_t j = _emit( PhenotypeCriteria::JT);
+        _emit( PhenotypeCriteria::POP);
+        Type rt;
+        if ( !_and( rt))
+            return false;
+        if ( t != BOOL || rt != BOOL)
+            return _fail( "Operands of 'or' must be boolean");
+        _pc._code[j].id = int( _pc._code.size());
+    }   // end while
+    return true;
+}   // end _or
+
+
+bool CriteriaCompiler::_and( Type &t)
+{
+    if ( !_compare( t))
+        return false;
+    while ( _accept("and"))
+    {
+        const size_t j = _emit( PhenotypeCriteria::JF);
+        _emit( PhenotypeCriteria::POP);
+        Type rt;
+        if ( !_compare( rt))
+            return false;
+        if ( t != BOOL || rt != BOOL)
+            return _fail( "Operands of 'and' must be boolean");
+        _pc._code[j].id = int( _pc._code.size());
+    }   // end while
+    return true;
+}   // end _and
+
+
+bool CriteriaCompiler::_compare( Type &t)
+{
+    if ( !_add( t))
+        return false;
+
+    PhenotypeCriteria::Op op;
+    if ( _accept("<"))
+        op = PhenotypeCriteria::LT;
+    else if ( _accept("<="))
+        op = PhenotypeCriteria::LE;
+    else if ( _accept(">"))
+        op = PhenotypeCriteria::GT;
+    else if ( _accept(">="))
+        op = PhenotypeCriteria::GE;
+    else if ( _accept("=="))
+        op = PhenotypeCriteria::EQ;
+    else if ( _accept("~="))
+        op = PhenotypeCriteria::NE;
+    else
+        return true;
+
+    Type rt;
+    if ( !_add( rt))
+        return false;
+    const bool isEq = op == PhenotypeCriteria::EQ || op == PhenotypeCriteria::NE;
+    if ( t == METRIC || rt == METRIC || (!isEq && (t != NUM || rt != NUM)) || (isEq && t != rt))
+        return _fail( "Invalid operands for comparison");
+    _emit( op);
+    t = BOOL;
+    return true;
+}   // end _compare
+
+
+bool CriteriaCompiler::_add( Type &t)
+{
+    if ( !_mul( t))
+        return false;
+    while ( _isSym("+") || _isSym("-"))
+    {
+        const PhenotypeCriteria::Op op = _accept("+") ? PhenotypeCriteria::ADD : PhenotypeCriteria::SUB;
+        if ( op == PhenotypeCriteria::SUB)
+            _pos++;
+        Type rt;
+        if ( !_mul( rt))
+            return false;
+        if ( t != NUM || rt != NUM)
+            return _fail( "Arithmetic operands must be numbers");
+        _emit( op);
+    }   // end while
+    return true;
+}   // end _add
+
+
+bool CriteriaCompiler::_mul( Type &t)
+{
+    if ( !_unary( t))
+        return false;
+    while ( _isSym("*") || _isSym("/"))
+    {
+        const PhenotypeCriteria::Op op = _accept("*") ? PhenotypeCriteria::MUL : PhenotypeCriteria::DIV;
+        if ( op == PhenotypeCriteria::DIV)
+            _pos++;
+        Type rt;
+        if ( !_unary( rt))
+            return false;
+        if ( t != NUM || rt != NUM)
+            return _fail( "Arithmetic operands must be numbers");
+        _emit( op);
+    }   // end while
+    return true;
+}   // end _mul
+
+
+bool CriteriaCompiler::_unary( Type &t)
+{
+    if ( _accept("not"))
+    {
+        if ( !_unary( t))
+            return false;
+        if ( t != BOOL)
+            return _fail( "Operand of 'not' must be boolean");
+        _emit( PhenotypeCriteria::NOT);
+        return true;
+    }   // end if
+
+    if ( _accept("-"))
+    {
+        if ( !_unary( t))
+            return false;
+        if ( t != NUM)
+            return _fail( "Operand of unary minus must be a number");
+        _emit( PhenotypeCriteria::NEG);
+        return true;
+    }   // end if
+
+    return _primary( t);
+}   // end _unary
+
+
+// Parse a primary expression. If it's a metric (not followed by a method call),
+// no code is emitted, t is set to METRIC, and its set and ID are set in _mset and _mid.
+bool CriteriaCompiler::_primary( Type &t)
+{
+    const Token &tok = _peek();
+    if ( tok.type == Token::NUMBER)
+    {
+        _emit( PhenotypeCriteria::CONST, 0, 0, 0, tok.num);
+        _pos++;
+        t = NUM;
+        return true;
+    }   // end if
+
+    if ( _accept("true") || _accept("false"))
+    {
+        _emit( PhenotypeCriteria::CONST, 0, 0, 0, _toks[_pos-1].s == "true" ? 1.0 : 0.0);
+        t = BOOL;
+        return true;
+    }   // end if
+
+    if ( _accept("("))
+        return _or( t) && _expect(")");
+
+    std::string nm;
+    if ( !_name( nm))
+        return false;
+
+    int set = -1;
+    int mid = -1;
+    if ( _locals.count(nm) > 0)
+    {
+        const Local &loc = _locals.at(nm);
+        if ( loc.type != METRIC)
+        {
+            _emit( PhenotypeCriteria::LOAD, 0, loc.idx);
+            t = loc.type;
+            return true;
+        }   // end if
+        set = loc.set;
+        mid = loc.mid;
+    }   // end if
+    else if ( _nparams > 0 && nm == _params[0])
+    {
+        _emit( PhenotypeCriteria::AGE);
+        t = NUM;
+        return true;
+    }   // end else if
+    else
+    {
+        for ( int i = 1; i < _nparams; ++i)
+            if ( nm == _params[i])
+                set = i-1;
+        if ( set < 0)
+            return _fail( "Unknown name '" + nm + "'");
+        if ( !_expect(":") || !_expect("metric") || !_expect("(") || !_integer( mid) || !_expect(")"))
+            return false;
+        _pc._mids.insert( mid);
+    }   // end else
+
+    if ( !_accept(":"))
+    {
+        t = METRIC;
+        _mset = set;
+        _mid = mid;
+        return true;
+    }   // end if
+    return _method( set, mid, t);
+}   // end _primary
+
+
+bool CriteriaCompiler::_method( int set, int mid, Type &t)
+{
+    std::string nm;
+    if ( !_name( nm) || !_expect("("))
+        return false;
+
+    int dim = 0;
+    t = NUM;
+    if ( nm == "zscore" || nm == "mean")
+    {
+        Type at;
+        if ( !_or( at))
+            return false;
+        if ( at != NUM)
+            return _fail( "Age argument must be a number");
+        if ( _accept(",") && !_integer( dim))
+            return false;
+        _emit( nm == "zscore" ? PhenotypeCriteria::ZSCORE : PhenotypeCriteria::MEAN, set, mid, dim);
+    }   // end if
+    else if ( nm == "value")
+    {
+        if ( !_isSym(")") && !_integer( dim))
+            return false;
+        _emit( PhenotypeCriteria::VALUE, set, mid, dim);
+    }   // end else if
+    else if ( nm == "ndims")
+        _emit( PhenotypeCriteria::NDIMS, set, mid);
+    else
+        return _fail( "Unknown metric function '" + nm + "'");
+
+    return _expect(")");
+}   // end _method
+
+}}   // end namespaces
+
+
+PhenotypeCriteria::Ptr PhenotypeCriteria::compile( const std::string &src, std::string *err)
+{
+    std::vector<Token> toks;
+    std::string terr;
+    Ptr pc( new PhenotypeCriteria, []( PhenotypeCriteria *d){ delete d;});
+    if ( tokenize( src, toks, terr))
+    {
+        CriteriaCompiler compiler( toks, *pc);
+        if ( compiler.compile())
+        {
+            pc->_src = src;
+            return pc;
+        }   // end if
+        terr = compiler.error();
+    }   // end if
+
+    if ( err)
+        *err = terr;
+    return nullptr;
+}   // end compile
+
+
+bool PhenotypeCriteria::evaluate( float age, const MetricSet &mset, const MetricSet &lset, const MetricSet &rset) const
+{
+    const MetricSet *sets[3] = {&mset, &lset, &rset};
+    double stack[MAX_STACK];
+    double locals[MAX_LOCALS];
+    int sp = 0;
+
+    const size_t n = _code.size();
+    size_t pc = 0;
+    while ( pc < n)
+    {
+        const Instr &in = _code[pc++];
+        switch ( in.op)
+        {
+            case CONST:
+                stack[sp++] = in.val;
+                break;
+            case AGE:
+                stack[sp++] = age;
+                break;
+            case LOAD:
+                stack[sp++] = locals[in.id];
+                break;
+            case STORE:
+                locals[in.id] = stack[--sp];
+                break;
+            case ZSCORE:
+            case MEAN:
+            case VALUE:
+            case NDIMS:
+            {
+                const MetricSet &ms = *sets[in.set];
+                if ( !ms.has( in.id))
+                    return false;
+                const MetricValue &mv = ms.metric( in.id);
+                if ( in.op == NDIMS)
+                {
+                    stack[sp++] = double( mv.ndims());
+                    break;
+                }   // end if
+                if ( size_t(in.dim) >= mv.ndims())
+                    return false;
+                if ( in.op == ZSCORE)
+                    stack[sp-1] = mv.zscore( float( stack[sp-1]), size_t(in.dim));
+                else if ( in.op == MEAN)
+                    stack[sp-1] = mv.mean( float( stack[sp-1]), size_t(in.dim));
+                else
+                    stack[sp++] = mv.value( size_t(in.dim));
+                break;
+            }   // end case
+            case ADD:
+                --sp;
+                stack[sp-1] += stack[sp];
+                break;
+            case SUB:
+                --sp;
+                stack[sp-1] -= stack[sp];
+                break;
+            case MUL:
+                --sp;
+                stack[sp-1] *= stack[sp];
+                break;
+            case DIV:
+                --sp;
+                stack[sp-1] /= stack[sp];
+                break;
+            case NEG:
+                stack[sp-1] = -stack[sp-1];
+                break;
+            case LT:
+                --sp;
+                stack[sp-1] = stack[sp-1] < stack[sp] ? 1.0 : 0.0;
+                break;
+            case LE:
+                --sp;
+                stack[sp-1] = stack[sp-1] <= stack[sp] ? 1.0 : 0.0;
+                break;
+            case GT:
+                --sp;
+                stack[sp-1] = stack[sp-1] > stack[sp] ? 1.0 : 0.0;
+                break;
+            case GE:
+                --sp;
+                stack[sp-1] = stack[sp-1] >= stack[sp] ? 1.0 : 0.0;
+                break;
+            case EQ:
+                --sp;
+                stack[sp-1] = stack[sp-1] == stack[sp] ? 1.0 : 0.0;
+                break;
+            case NE:
+                --sp;
+                stack[sp-1] = stack[sp-1] != stack[sp] ? 1.0 : 0.0;
+                break;
+            case NOT:
+                stack[sp-1] = stack[sp-1] == 0.0 ? 1.0 : 0.0;
+                break;
+            case JF:
+                if ( stack[sp-1] == 0.0)
+                    pc = size_t(in.id);
+                break;
+            case JT:
+                if ( stack[sp-1] != 0.0)
+                    pc = size_t(in.id);
+                break;
+            case POP:
+                --sp;
+                break;
+        }   // end switch
+    }   // end while
+
+    return sp > 0 && stack[sp-1] != 0.0;
+}   // end evaluate
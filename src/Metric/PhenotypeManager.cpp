@@ -17,6 +17,8 @@
 
 #include <Metric/PhenotypeManager.h>
 #include <Metric/MetricManager.h>
+#include <Metric/DefinitionCache.h>
+#include <MiscFunctions.h>
 #include <QFile>
 #include <QDir>
 #include <rlib/FileIO.h>
@@ -24,6 +26,7 @@
 #include <cassert>
 using FaceTools::Metric::PhenotypeManager;
 using FaceTools::Metric::Phenotype;
+using FaceTools::Metric::DefinitionCache;
 using FaceTools::FM;
 
 // Static definitions
@@ -33,6 +36,7 @@ QStringList PhenotypeManager::_regions;
 std::unordered_map<int, Phenotype::Ptr> PhenotypeManager::_hpos;
 std::unordered_map<int, IntSet> PhenotypeManager::_mhpos;
 std::unordered_map<QString, IntSet> PhenotypeManager::_rhpos;
+std::vector<Phenotype::Ptr> PhenotypeManager::_hvec;
 
 
 namespace {
@@ -120,6 +124,7 @@ int PhenotypeManager::load( const QString& sdir)
     _hpos.clear();
     _mhpos.clear();
     _rhpos.clear();
+    _hvec.clear();
 
     QDir hdir( sdir);
     if ( !hdir.exists() || !hdir.isReadable())
@@ -129,16 +134,49 @@ int PhenotypeManager::load( const QString& sdir)
     }   // end if
 
     const QStringList fnames = hdir.entryList( QDir::Files | QDir::Readable, QDir::Type | QDir::Name);
-    int lrecs = 0;
+    QStringList fpaths;
     for ( const QString& fname : fnames)
+        fpaths << hdir.absoluteFilePath(fname);
+
+    // Restore the terms from the snapshot unless the scripts have changed since it was made.
+    std::vector<Phenotype::Ptr> hpos;
+    DefinitionCache cache( "phenotypes", fpaths);
+    if ( QDataStream *is = cache.read())
+    {
+        quint32 n = 0;
+        *is >> n;
+        for ( quint32 i = 0; i < n && is->status() == QDataStream::Ok; ++i)
+            if ( Phenotype::Ptr hpo = Phenotype::read( *is))
+                hpos.push_back( hpo);
+        if ( is->status() != QDataStream::Ok)
+            hpos.clear();
+    }   // end if
+
+    if ( hpos.empty())
     {
-        Phenotype::Ptr hpo = Phenotype::load( hdir.absoluteFilePath(fname));
-        if ( !hpo)
+        for ( const QString& fpath : fpaths)
         {
-            std::cerr << "[WARN] FaceTools::Metric::PhenotypeManager::load: Error loading Lua script " << fname.toStdString() << std::endl;
-            continue;
-        }   // end else
+            Phenotype::Ptr hpo = Phenotype::load( fpath);
+            if ( !hpo)
+            {
+                std::cerr << "[WARN] FaceTools::Metric::PhenotypeManager::load: Error loading Lua script " << fpath.toStdString() << std::endl;
+                continue;
+            }   // end if
+            hpos.push_back( hpo);
+        }   // end for
+
+        if ( QDataStream *os = cache.write())
+        {
+            *os << quint32(hpos.size());
+            for ( const Phenotype::Ptr &hpo : hpos)
+                hpo->write( *os);
+            cache.commit();
+        }   // end if
+    }   // end if
 
+    int lrecs = 0;
+    for ( const Phenotype::Ptr &hpo : hpos)
+    {
         // If there are no objective criteria defined, skip this HPO term.
         if ( checkMissingCriteria( hpo))
             continue;
@@ -161,19 +199,34 @@ int PhenotypeManager::load( const QString& sdir)
 
     _names.sort();
     _regions.sort();
+
+    for ( int id : _ids)
+        _hvec.push_back( _hpos.at(id));
+
     return lrecs;
 }   // end load
 
 
 IntSet PhenotypeManager::discover( const FM* fm, int aid)
 {
-    IntSet dids;
-    for ( const auto& p : _hpos)
+    return discover( std::vector<const FM*>( 1, fm), aid).front();
+}   // end discover
+
+
+std::vector<IntSet> PhenotypeManager::discover( const std::vector<const FM*> &fms, int aid)
+{
+    const size_t nh = _hvec.size();
+    std::vector<char> present( fms.size() * nh, 0);
+    parallelChunks( present.size(), [&]( size_t i0, size_t i1)
     {
-        Phenotype::Ptr hpo = p.second;
-        if ( hpo->isPresent(fm, aid))
-            dids.insert( hpo->id());
-    }   // end for
+        for ( size_t i = i0; i < i1; ++i)
+            present[i] = _hvec[i % nh]->isPresent( fms[i / nh], aid);
+    }, 8);
+
+    std::vector<IntSet> dids( fms.size());
+    for ( size_t i = 0; i < present.size(); ++i)
+        if ( present[i])
+            dids[i / nh].insert( _hvec[i % nh]->id());
     return dids;
 }   // end discover
 
@@ -17,13 +17,60 @@
 
 #include <Metric/StatisticsManager.h>
 #include <Metric/MetricManager.h>
+#include <Metric/DefinitionCache.h>
 #include <QDir>
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 using FaceTools::Metric::StatisticsManager;
+using FaceTools::Metric::DefinitionCache;
+using FaceTools::Metric::GrowthData;
+using MM = FaceTools::Metric::MetricManager;
+
+
+namespace {
+
+// Read the growth data of all metrics (as they were after consolidation) from the snapshot.
+// Returns the number of files the snapshot was made from or -1 if the snapshot is invalid.
+int readSnapshot( QDataStream &is, std::vector<GrowthData::Ptr> &gds)
+{
+    qint32 nloaded = 0;
+    quint32 n = 0;
+    is >> nloaded >> n;
+    for ( quint32 i = 0; i < n && is.status() == QDataStream::Ok; ++i)
+    {
+        GrowthData::Ptr gd = GrowthData::read( is);
+        if ( !gd || !MM::metric( gd->metricId()) || MM::metric( gd->metricId())->dims() != gd->dims())
+            return -1;
+        gds.push_back(gd);
+    }   // end for
+    return is.status() == QDataStream::Ok ? nloaded : -1;
+}   // end readSnapshot
+
+
+void writeSnapshot( QDataStream &os, int nloaded)
+{
+    std::vector<const GrowthData*> gds;
+    const IntSet &mids = MM::ids();
+    std::vector<int> smids( mids.begin(), mids.end());
+    std::sort( smids.begin(), smids.end());
+    for ( int mid : smids)
+    {
+        // In ID order so restored growth data are given the same IDs
+        const FaceTools::Metric::GrowthDataRanker &gdr = MM::metric(mid)->growthData();
+        for ( size_t i = 0; i < gdr.all().size(); ++i)
+            gds.push_back( gdr.stats( int(i)));
+    }   // end for
+
+    os << qint32(nloaded) << quint32(gds.size());
+    for ( const GrowthData *gd : gds)
+        gd->write( os);
+}   // end writeSnapshot
+
+}   // end namespace
 
 
 int StatisticsManager::load( const QString& dname)
@@ -35,18 +82,39 @@ int StatisticsManager::load( const QString& dname)
         return -1;
     }   // end if
 
-    int nloaded = 0;
     const QStringList fnames = mdir.entryList( QDir::Files | QDir::Readable, QDir::Type | QDir::Name);
+    QStringList fpaths;
     for ( const QString& fname : fnames)
+        fpaths << mdir.absoluteFilePath(fname);
+
+    // Growth data (including those made by consolidation) are restored from the snapshot
+    // unless the statistics or the metrics they were made for have changed since.
+    DefinitionCache cache( "statistics", fpaths, DefinitionCache::key( "metrics"));
+    std::vector<GrowthData::Ptr> gds;
+    int nloaded = -1;
+    if ( QDataStream *is = cache.read())
+        nloaded = readSnapshot( *is, gds);
+
+    const bool restored = nloaded >= 0;
+    if ( restored)
+    {
+        for ( const GrowthData::Ptr &gd : gds)
+            MM::metric( gd->metricId())->growthData().add( gd);
+    }   // end if
+    else
     {
-        if ( !GrowthData::load( mdir.absoluteFilePath(fname)))
+        nloaded = 0;
+        for ( const QString& fpath : fpaths)
         {
-            qWarning() << "Unable to load statistics from " << mdir.absoluteFilePath(fname);
-            continue;
-        }   // end if
+            if ( !GrowthData::load( fpath))
+            {
+                qWarning() << "Unable to load statistics from " << fpath;
+                continue;
+            }   // end if
 
-        nloaded++;
-    }   // end for
+            nloaded++;
+        }   // end for
+    }   // end else
 
     // For all metrics, consolidate growth data.
     for ( const QString &nm : MetricManager::names())
@@ -55,7 +123,7 @@ int StatisticsManager::load( const QString& dname)
 #ifndef NDEBUG
         std::cerr << QString("Metric %1 \"%2\": ").arg( mc->id(), int(4), int(10), QChar('0')).arg(mc->name()).toStdString();
 #endif
-        if ( !mc->growthData().empty())
+        if ( !restored && !mc->growthData().empty())
         {
             mc->growthData().combineSexes();       // Combine single sex growth curve datasets
             //mc->growthData().combineEthnicities(); // Make ethnic pairs for same sexes
@@ -87,5 +155,14 @@ int StatisticsManager::load( const QString& dname)
 #endif
     }   // end for
 
+    if ( !restored)
+    {
+        if ( QDataStream *os = cache.write())
+        {
+            writeSnapshot( *os, nloaded);
+            cache.commit();
+        }   // end if
+    }   // end if
+
     return nloaded;
 }   // end load
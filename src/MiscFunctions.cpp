@@ -20,8 +20,12 @@
 #include <r3d/AStarSearch.h>
 #include <QTextStream>
 #include <QString>
+#include <QThread>
 #include <QFile>
+#include <unordered_set>
 #include <algorithm>
+#include <thread>
+#include <cmath>
 using r3d::Mesh;
 using r3d::Vec3f;
 using FaceTools::byte;
@@ -592,3 +596,79 @@ QString FaceTools::getRmLine( std::istringstream& is, bool lower)
     return qln;
 }   // end getRmLine
 
+
+namespace {
+thread_local size_t t_maxChunkThreads = 0;  // Zero for QThread::idealThreadCount
+
+// Run fn over [i0,i1) with nested calls to parallelChunks from this thread run serially.
+void runSerialChunk( const std::function<void( size_t, size_t)> &fn, size_t i0, size_t i1)
+{
+    const size_t oldMax = t_maxChunkThreads;
+    t_maxChunkThreads = 1;
+    fn( i0, i1);
+    t_maxChunkThreads = oldMax;
+}   // end runSerialChunk
+}   // end namespace
+
+
+void FaceTools::setParallelChunksThreads( size_t n) { t_maxChunkThreads = n;}
+
+
+void FaceTools::parallelChunks( size_t n, const std::function<void( size_t, size_t)> &fn, size_t minChunk)
+{
+    if ( n == 0)
+        return;
+    minChunk = std::max<size_t>( 1, minChunk);
+    size_t maxThreads = t_maxChunkThreads;
+    if ( maxThreads == 0)
+        maxThreads = size_t( std::max( 1, QThread::idealThreadCount()));
+    const size_t nthreads = std::min( maxThreads, (n + minChunk - 1) / minChunk);
+    if ( nthreads <= 1)
+    {
+        fn( 0, n);
+        return;
+    }   // end if
+
+    const size_t csz = (n + nthreads - 1) / nthreads;
+    std::vector<std::thread> workers;
+    for ( size_t i = 1; i < nthreads; ++i)
+    {
+        const size_t i0 = i * csz;
+        const size_t i1 = std::min( n, i0 + csz);
+        if ( i0 < i1)
+            workers.push_back( std::thread( runSerialChunk, std::cref(fn), i0, i1));
+    }   // end for
+    runSerialChunk( fn, 0, std::min( n, csz));  // First chunk on the calling thread
+    for ( std::thread &t : workers)
+        t.join();
+}   // end parallelChunks
+
+
+std::vector<int> FaceTools::subsampleVertices( const Mesh &mesh, float cellSize)
+{
+    assert( mesh.hasSequentialIds());
+    const int N = int(mesh.numVtxs());
+    std::vector<int> vidxs;
+    if ( cellSize <= 0)
+    {
+        vidxs.resize( N);
+        for ( int i = 0; i < N; ++i)
+            vidxs[i] = i;
+        return vidxs;
+    }   // end if
+
+    // Cell coordinates packed into 21 bits each
+    static const int64_t OFFSET = int64_t(1) << 20;
+    static const int64_t MASK = (int64_t(1) << 21) - 1;
+    std::unordered_set<int64_t> cells;
+    for ( int i = 0; i < N; ++i)
+    {
+        const Vec3f &v = mesh.vtx(i);
+        int64_t key = 0;
+        for ( int j = 0; j < 3; ++j)
+            key = (key << 21) | ((int64_t( std::floor( v[j] / cellSize)) + OFFSET) & MASK);
+        if ( cells.insert( key).second)
+            vidxs.push_back(i);
+    }   // end for
+    return vidxs;
+}   // end subsampleVertices
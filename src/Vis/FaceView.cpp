@@ -23,8 +23,14 @@
 #include <Action/ModelSelector.h>
 #include <FaceModelCurvature.h>
 #include <FaceModelViewer.h>
+#include <MiscFunctions.h>
 #include <FaceModel.h>
 #include <vtkProperty.h>
+#include <vtkPointData.h>
+#include <vtkCellData.h>
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
 #include <r3dvis/VtkTools.h>
 #include <QColor>
 #include <iostream>
@@ -162,11 +168,27 @@ void FaceView::reset()
         _texture = nullptr;
     }   // end if
 
-    // Create the new actor from the data
-    _actor = r3dvis::VtkActorCreator::generateActor( _data->mesh());
-    _texture = _actor->GetTexture();
-
-    resetNormals();
+    const FaceView *sfv = _sharedView();
+    if ( sfv)
+    {
+        // Another view of the model already has polydata from its current mesh so use those
+        vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData( r3dvis::getPolyData( sfv->_actor));
+        _actor = vtkSmartPointer<vtkActor>::New();
+        _actor->SetMapper( mapper);
+        _texture = sfv->_texture;
+        _actor->SetTexture( _texture);
+        _nrms = sfv->_nrms;
+        _mesh = sfv->_mesh;
+    }   // end if
+    else
+    {
+        // Create the new actor from the data
+        _actor = r3dvis::VtkActorCreator::generateActor( _data->mesh());
+        _texture = _actor->GetTexture();
+        _mesh = _data->meshPtr();
+        resetNormals();
+    }   // end else
 
     setBackfaceCulling(bface);
     setWireframe(wframe);
@@ -182,9 +204,190 @@ void FaceView::reset()
 
     for ( BV* vis : oldVisLayers)
         apply(vis);
+
+    if ( !sfv)
+        _shareWithViews();
 }   // end reset
 
 
+bool FaceView::_isCurrent() const
+{
+    const std::shared_ptr<const r3d::Mesh> mesh = _mesh.lock();
+    return _actor && mesh && mesh == _data->meshPtr();
+}   // end _isCurrent
+
+
+const FaceView* FaceView::_sharedView() const
+{
+    for ( const FaceView *fv : _data->fvs())
+        if ( fv != this && fv->_isCurrent())
+            return fv;
+    return nullptr;
+}   // end _sharedView
+
+
+void FaceView::_shareWithViews()
+{
+    // Switch the model's other views over to this view's polydata and texture
+    // and have them remap their visualisations into the now shared arrays.
+    vtkPolyData *pd = r3dvis::getPolyData( _actor);
+    for ( FaceView *fv : _data->fvs())
+    {
+        if ( fv == this || !fv->_actor || r3dvis::getPolyData( fv->_actor) == pd)
+            continue;
+        vtkPolyDataMapper *mapper = vtkPolyDataMapper::SafeDownCast( fv->_actor->GetMapper());
+        if ( !mapper)
+            continue;
+        const bool tex = fv->textured();
+        mapper->SetInputData( pd);
+        fv->_texture = _texture;
+        fv->_nrms = _nrms;
+        fv->_mesh = _mesh;
+        fv->setTextured( tex);
+        fv->_reapplyVisualisations();
+    }   // end for
+}   // end _shareWithViews
+
+
+namespace {
+
+// Returns true iff the polys of the given polydata are the faces of the given mesh (in ID order).
+bool hasSameFaces( const r3d::Mesh &mesh, vtkPolyData *pd)
+{
+    const vtkIdType nf = vtkIdType( mesh.numFaces());
+    if ( pd->GetNumberOfPolys() != nf)
+        return false;
+    vtkCellArray *polys = pd->GetPolys();
+    vtkIdType npts;
+    const vtkIdType *pts;
+    for ( vtkIdType fid = 0; fid < nf; ++fid)
+    {
+        polys->GetCellAtId( fid, npts, pts);
+        const int *fvidxs = mesh.fvidxs( int(fid));
+        if ( npts != 3 || pts[0] != fvidxs[0] || pts[1] != fvidxs[1] || pts[2] != fvidxs[2])
+            return false;
+    }   // end for
+    return true;
+}   // end hasSameFaces
+
+
+// Update the points and (if changed) polys of the given polydata from the given mesh in place.
+// Returns false without making changes if the faces changed and the polydata has texture coordinates.
+bool updatePolyData( const r3d::Mesh &mesh, vtkPolyData *pd)
+{
+    const vtkIdType nv = vtkIdType( mesh.numVtxs());
+    const bool sameFaces = hasSameFaces( mesh, pd);
+    const bool sameVtxs = pd->GetNumberOfPoints() == nv;
+    if ( (!sameFaces || !sameVtxs) && pd->GetPointData()->GetTCoords())
+        return false;
+
+    // Untransformed positions since the actor holds the model's transform.
+    vtkPoints *pts = pd->GetPoints();
+    pts->SetNumberOfPoints( nv);
+    if ( pts->GetDataType() == VTK_FLOAT)
+    {
+        float *dst = static_cast<float*>( pts->GetVoidPointer(0));
+        FaceTools::parallelChunks( size_t(nv), [&]( size_t i0, size_t i1)
+        {
+            for ( size_t i = i0; i < i1; ++i)
+            {
+                const FaceTools::Vec3f &v = mesh.uvtx( int(i));
+                dst[3*i+0] = v[0];
+                dst[3*i+1] = v[1];
+                dst[3*i+2] = v[2];
+            }   // end for
+        }, 1<<14);
+    }   // end if
+    else
+    {
+        for ( vtkIdType i = 0; i < nv; ++i)
+        {
+            const FaceTools::Vec3f &v = mesh.uvtx( int(i));
+            pts->SetPoint( i, v[0], v[1], v[2]);
+        }   // end for
+    }   // end else
+    pts->Modified();
+
+    if ( !sameVtxs)
+        pd->GetPointData()->Initialize();   // Arrays no longer match the points
+    else
+    {
+        // Remove the mapped arrays (now stale) keeping the texture coordinates (normals are reset after).
+        vtkPointData *ptd = pd->GetPointData();
+        for ( int i = ptd->GetNumberOfArrays() - 1; i >= 0; --i)
+            if ( ptd->GetAbstractArray(i) != ptd->GetTCoords())
+                ptd->RemoveArray(i);
+    }   // end else
+    pd->GetCellData()->Initialize();
+
+    if ( !sameFaces)
+    {
+        const int nf = int( mesh.numFaces());
+        vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+        polys->AllocateExact( nf, 3*nf);
+        for ( int fid = 0; fid < nf; ++fid)
+        {
+            const int *fvidxs = mesh.fvidxs( fid);
+            const vtkIdType ids[3] = {fvidxs[0], fvidxs[1], fvidxs[2]};
+            polys->InsertNextCell( 3, ids);
+        }   // end for
+        pd->SetPolys( polys);
+    }   // end if
+
+    pd->Modified();
+    return true;
+}   // end updatePolyData
+
+}   // end namespace
+
+
+void FaceView::update()
+{
+    assert(_viewer);
+    if ( !_isCurrent())
+    {
+        // Polydata not yet updated by another view of the model since its mesh changed
+        const r3d::Mesh &mesh = _data->mesh();
+        vtkPolyData *pd = _actor ? r3dvis::getPolyData( _actor) : nullptr;
+        if ( !pd || !mesh.hasSequentialIds() || !updatePolyData( mesh, pd))
+        {
+            reset();
+            return;
+        }   // end if
+
+        _mesh = _data->meshPtr();
+        resetNormals();
+        for ( FaceView *fv : _data->fvs())
+        {
+            if ( fv != this && fv->_actor && r3dvis::getPolyData( fv->_actor) == pd)
+            {
+                fv->_nrms = _nrms;
+                fv->_mesh = _mesh;
+            }   // end if
+        }   // end for
+    }   // end if
+
+    _reapplyVisualisations();
+}   // end update
+
+
+void FaceView::_reapplyVisualisations()
+{
+    // Purge the visualisation layers (removing their now stale arrays) then reapply those that were visible.
+    VisualisationLayers oldVisLayers;
+    for ( BV* vis : _vlayers)
+        if ( vis->isVisible(this))
+            oldVisLayers.insert( vis);
+
+    while ( !_vlayers.empty())
+        purge( *_vlayers.begin());
+
+    for ( BV* vis : oldVisLayers)
+        if ( vis->isAvailable( this, nullptr))
+            apply(vis);
+}   // end _reapplyVisualisations
+
+
 #ifndef NDEBUG
 namespace {
 
@@ -17,6 +17,7 @@
 
 #include <Vis/MaskView.h>
 #include <Vis/FaceView.h>
+#include <FaceModelCurvature.h>
 #include <r3dvis/VtkActorCreator.h>
 #include <vtkPointData.h>
 using FaceTools::Vis::MaskView;
@@ -29,8 +30,8 @@ MaskView::MaskView( const r3d::Mesh &mesh) : SimpleView()
     actor->SetPickable( false);
 
     // Set curvature data
-    const r3d::Curvature cv( const_cast<r3d::Mesh&>(mesh)); // Have to do this for now - should make a one shot version...
-    vtkSmartPointer<vtkFloatArray> nrms = r3dvis::makeNormals( cv);
+    const FaceTools::CurvatureMap::Ptr cmap = FaceTools::CurvatureMap::create( mesh);
+    vtkSmartPointer<vtkFloatArray> nrms = FaceTools::makeNormals( *cmap);
     nrms->SetName("Normals");
     r3dvis::getPolyData(actor)->GetPointData()->SetNormals(nrms);
 
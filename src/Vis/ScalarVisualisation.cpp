@@ -91,14 +91,6 @@ bool ScalarVisualisation::isVisible( const FV *fv) const
 void ScalarVisualisation::deactivate( FV *fv)
 {
     vtkActor *actor = const_cast<vtkActor*>( fv->actor());
-    const std::string lab = label().toStdString();
-
-    // NB While both vtkCellData and vtkPointData are vtkDataSetAttributes, VTK's design
-    // precludes being able to use vtkDataSetAttributes::SetActiveScalars polymorphically.
-    if ( mapsPolys())
-        r3dvis::getPolyData(actor)->GetCellData()->SetActiveScalars("");
-    else
-        r3dvis::getPolyData(actor)->GetPointData()->SetActiveScalars("");
     actor->GetMapper()->SetScalarVisibility( false);
     _activated.erase(fv);
 }   // end deactivate
@@ -107,19 +99,20 @@ void ScalarVisualisation::deactivate( FV *fv)
 void ScalarVisualisation::activate( FV *fv)
 {
     vtkActor *actor = const_cast<vtkActor*>(fv->actor());
-    vtkPolyData *pd = r3dvis::getPolyData( actor);
+    vtkMapper *mapper = actor->GetMapper();
     const std::string lab = label().toStdString();
 
-    actor->GetMapper()->SetLookupTable( lookupTable( fv->viewer()->getRenderer()));
+    mapper->SetLookupTable( lookupTable( fv->viewer()->getRenderer()));
 
-    // NB While both vtkCellData and vtkPointData are vtkDataSetAttributes, VTK's design
-    // precludes being able to use vtkDataSetAttributes::SetActiveScalars polymorphically.
+    // The mapped array is selected on the view's own mapper rather than being set as the active
+    // scalars of the polydata since the polydata are shared by all views of the same model.
     if ( mapsPolys())
-        pd->GetCellData()->SetActiveScalars( lab.c_str());
+        mapper->SetScalarModeToUseCellFieldData();
     else
-        pd->GetPointData()->SetActiveScalars( lab.c_str());
+        mapper->SetScalarModeToUsePointFieldData();
+    mapper->SelectColorArray( lab.c_str());
 
-    actor->GetMapper()->SetScalarRange( minVisible(), maxVisible());
-    actor->GetMapper()->SetScalarVisibility( true);
+    mapper->SetScalarRange( minVisible(), maxVisible());
+    mapper->SetScalarVisibility( true);
     _activated.insert(fv);
 }   // end activate
@@ -66,12 +66,6 @@ void VectorVisualisation::setScalarMapping( const FV *fv, ScalarVisualisation *s
 void VectorVisualisation::deactivate( FV *fv)
 {
     assert( _glyphs.count(fv) > 0);
-    // NB While both vtkCellData and vtkPointData are vtkDataSetAttributes, VTK's design
-    // precludes being able to use vtkDataSetAttributes::SetActiveScalars polymorphically.
-    if ( mapsPolys())
-        r3dvis::getPolyData(fv->actor())->GetCellData()->SetActiveVectors("");
-    else
-        r3dvis::getPolyData(fv->actor())->GetPointData()->SetActiveVectors("");
     fv->viewer()->remove( _glyphs[fv]->prop());
     _glyphs.erase(fv);
 }   // end deactivate
@@ -80,9 +74,13 @@ void VectorVisualisation::deactivate( FV *fv)
 void VectorVisualisation::activate( FV *fv)
 {
     assert( _glyphs.count(fv) == 0);
-    vtkPolyData *pd = r3dvis::getPolyData( fv->actor());
     const std::string lab = label().toStdString();
 
+    // The glyphs are made from a shallow copy (sharing the arrays) of the view's polydata so the
+    // active vectors are set independently of the other views of the model sharing the polydata.
+    vtkSmartPointer<vtkPolyData> pd = vtkSmartPointer<vtkPolyData>::New();
+    pd->ShallowCopy( r3dvis::getPolyData( fv->actor()));
+
     // NB While both vtkCellData and vtkPointData are vtkDataSetAttributes, VTK's design
     // precludes being able to use vtkDataSetAttributes::SetActiveScalars polymorphically.
     if ( mapsPolys())
@@ -0,0 +1,372 @@
+/************************************************************************
+ * Copyright (C) 2020 SIS Research Ltd & Richard Palmer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <ViscoElasticRegistration.h>
+#include <MiscFunctions.h>
+#include <unordered_set>
+#include <algorithm>
+#include <cmath>
+using FaceTools::ViscoElasticRegistration;
+using FaceTools::MatX3f;
+using FaceTools::Vec3f;
+
+
+namespace {
+
+// Per vertex normals (area weighted) from the given vertex positions and the mesh's topology.
+MatX3f calcNormals( const r3d::Mesh &mesh, const MatX3f &V)
+{
+    const size_t N = size_t(V.rows());
+    MatX3f nrms( N, 3);
+    FaceTools::parallelChunks( N, [&]( size_t i0, size_t i1)
+    {
+        for ( size_t i = i0; i < i1; ++i)
+        {
+            Vec3f nrm = Vec3f::Zero();
+            for ( int fid : mesh.faces(int(i)))
+            {
+                const int *fvidxs = mesh.fvidxs(fid);
+                const Vec3f v0 = V.row(fvidxs[0]).transpose();
+                const Vec3f v1 = V.row(fvidxs[1]).transpose();
+                const Vec3f v2 = V.row(fvidxs[2]).transpose();
+                nrm += (v1 - v0).cross(v2 - v0);  // Length is twice the face area
+            }   // end for
+            const float len = nrm.norm();
+            nrms.row(i) = (len > 0 ? Vec3f( nrm / len) : nrm).transpose();
+        }   // end for
+    }, 256);
+    return nrms;
+}   // end calcNormals
+
+
+MatX3f vertexRows( const r3d::Mesh &mesh)
+{
+    const size_t N = mesh.numVtxs();
+    MatX3f V( N, 3);
+    for ( size_t i = 0; i < N; ++i)
+        V.row(i) = mesh.vtx(int(i)).transpose();
+    return V;
+}   // end vertexRows
+
+
+// Smoothing neighbourhoods over the floating mesh. Each vertex's neighbours are its K closest vertices
+// (itself included) found by growing out over the mesh's one-rings, with Gaussian weights on distance.
+struct Neighbourhoods
+{
+    Neighbourhoods( const r3d::Mesh &mesh, const MatX3f &V, size_t K, float sigma)
+        : offsets( V.rows() + 1, 0)
+    {
+        const size_t N = size_t(V.rows());
+        const float isig2 = 1.0f / (2 * sigma * sigma);
+        std::vector<std::vector<std::pair<float,int> > > nbs( N);
+        FaceTools::parallelChunks( N, [&]( size_t i0, size_t i1)
+        {
+            std::vector<int> front, next;
+            std::unordered_set<int> seen;
+            for ( size_t i = i0; i < i1; ++i)
+            {
+                seen.clear();
+                front.assign( 1, int(i));
+                seen.insert( int(i));
+                while ( seen.size() < K && !front.empty())
+                {
+                    next.clear();
+                    for ( int v : front)
+                        for ( int fid : mesh.faces(v))
+                            for ( int j = 0; j < 3; ++j)
+                            {
+                                const int u = mesh.fvidxs(fid)[j];
+                                if ( seen.insert(u).second)
+                                    next.push_back(u);
+                            }   // end for
+                    front.swap( next);
+                }   // end while
+
+                std::vector<std::pair<float,int> > &nb = nbs[i];
+                for ( int u : seen)
+                    nb.push_back( std::make_pair( (V.row(u) - V.row(i)).squaredNorm(), u));
+                const size_t k = std::min( K, nb.size());
+                std::partial_sort( nb.begin(), nb.begin() + k, nb.end());
+                nb.resize( k);
+                for ( auto &p : nb)
+                    p.first = expf( -p.first * isig2);
+            }   // end for
+        }, 256);
+
+        for ( size_t i = 0; i < N; ++i)
+            offsets[i+1] = offsets[i] + nbs[i].size();
+        idxs.resize( offsets[N]);
+        wgts.resize( offsets[N]);
+        for ( size_t i = 0; i < N; ++i)
+        {
+            for ( size_t j = 0; j < nbs[i].size(); ++j)
+            {
+                wgts[offsets[i] + j] = nbs[i][j].first;
+                idxs[offsets[i] + j] = nbs[i][j].second;
+            }   // end for
+        }   // end for
+    }   // end ctor
+
+    // Set out to the (weighted if w not null) Gaussian average of in over each vertex's neighbourhood.
+    void smooth( const MatX3f &in, MatX3f &out, const std::vector<float> *w=nullptr) const
+    {
+        const size_t N = offsets.size() - 1;
+        out.resize( N, 3);
+        FaceTools::parallelChunks( N, [&]( size_t i0, size_t i1)
+        {
+            for ( size_t i = i0; i < i1; ++i)
+            {
+                Vec3f sum = Vec3f::Zero();
+                float wsum = 0;
+                for ( size_t j = offsets[i]; j < offsets[i+1]; ++j)
+                {
+                    const float g = w ? wgts[j] * (*w)[idxs[j]] : wgts[j];
+                    sum += g * in.row(idxs[j]).transpose();
+                    wsum += g;
+                }   // end for
+                out.row(i) = (wsum > 0 ? Vec3f( sum / wsum) : Vec3f::Zero()).transpose();
+            }   // end for
+        }, 256);
+    }   // end smooth
+
+    std::vector<size_t> offsets;
+    std::vector<int> idxs;
+    std::vector<float> wgts;
+};  // end struct
+
+
+// Anneal geometrically from n0 (first iteration) to n1 (last iteration).
+size_t anneal( size_t n0, size_t n1, size_t it, size_t nits)
+{
+    if ( nits <= 1 || n0 == 0 || n1 == 0)
+        return n1;
+    const double t = double(it) / (nits - 1);
+    return size_t( std::round( n0 * std::pow( double(n1) / n0, t)));
+}   // end anneal
+
+
+// Run nits update iterations (numbered from it0 of totalIts for annealing) moving the floating vertices V0 + D
+// toward the target points T with normals TN (as rows) using the given KD-tree over the target points.
+// Returns false if cancelled before all iterations were done.
+bool update( const FaceTools::MaskRegistration::Params &prms, const r3d::Mesh &floating, const Neighbourhoods &nbs,
+             const MatX3f &V0, MatX3f &D, const MatX3f &T, const MatX3f &TN, const r3d::KDTree &tkdt,
+             size_t it0, size_t nits, size_t totalIts, const FaceTools::CancelFn &cfn)
+{
+    using FaceTools::parallelChunks;
+    const size_t N = size_t(V0.rows());
+    const size_t M = size_t(T.rows());
+
+    // Inlier probability of a correspondence at kappa standard deviations is one half.
+    const float outp = expf( -0.5f * prms.kappa * prms.kappa);
+    const float minw = 1.0f - prms.flagThresh;
+
+    const size_t K = std::max<size_t>( 1, prms.k);
+
+    MatX3f V = V0 + D;
+    MatX3f U( N, 3), S( N, 3), tmp( N, 3);
+    std::vector<float> w( N);
+    std::vector<int> pullv( M);
+    MatX3f pullSum( N, 3);
+    std::vector<int> pullCnt( N);
+
+    for ( size_t it = it0; it < it0 + nits; ++it)
+    {
+        if ( FaceTools::CancelToken::isCancelled( cfn))
+            return false;
+
+        const MatX3f FN = calcNormals( floating, V);
+
+        // Push correspondences (floating vertex to the inverse distance weighted mean of its
+        // k closest target vertices having compatible orientations).
+        parallelChunks( N, [&]( size_t i0, size_t i1)
+        {
+            std::vector<int> nvidxs;
+            std::vector<float> sqdis;
+            for ( size_t i = i0; i < i1; ++i)
+            {
+                nvidxs.resize( K);
+                sqdis.resize( K);
+                const size_t nk = tkdt.findn( V.row(i).transpose(), nvidxs, &sqdis);
+                Vec3f sum = Vec3f::Zero();
+                float wsum = 0;
+                for ( size_t k = 0; k < nk; ++k)
+                {
+                    const int j = nvidxs[k];
+                    if ( prms.useOrient && FN.row(i).dot( TN.row(j)) <= 0)
+                        continue;
+                    const float g = 1.0f / std::max( sqrtf( sqdis[k]), 1e-6f);
+                    sum += g * T.row(j).transpose();
+                    wsum += g;
+                }   // end for
+                if ( wsum > 0)
+                {
+                    U.row(i) = (sum / wsum).transpose() - V.row(i);
+                    w[i] = 1.0f;
+                }   // end if
+                else
+                {
+                    U.row(i).setZero();
+                    w[i] = 0.0f;
+                }   // end else
+            }   // end for
+        });
+
+        // Pull correspondences (target vertex to closest floating vertex)
+        const r3d::Mesh::Ptr fmesh = r3d::Mesh::fromVertices( V);
+        const r3d::KDTree::Ptr fkdt = r3d::KDTree::create( *fmesh);
+        parallelChunks( M, [&]( size_t j0, size_t j1)
+        {
+            for ( size_t j = j0; j < j1; ++j)
+            {
+                const int i = fkdt->find( T.row(j).transpose());
+                pullv[j] = !prms.useOrient || FN.row(i).dot( TN.row(j)) > 0 ? i : -1;
+            }   // end for
+        });
+
+        pullSum.setZero();
+        std::fill( pullCnt.begin(), pullCnt.end(), 0);
+        for ( size_t j = 0; j < M; ++j)
+        {
+            const int i = pullv[j];
+            if ( i >= 0)
+            {
+                pullSum.row(i) += T.row(j) - V.row(i);
+                pullCnt[i]++;
+            }   // end if
+        }   // end for
+
+        // Combine into a single force per floating vertex
+        parallelChunks( N, [&]( size_t i0, size_t i1)
+        {
+            for ( size_t i = i0; i < i1; ++i)
+            {
+                if ( pullCnt[i] == 0)
+                {
+                    if ( w[i] == 0)
+                        U.row(i).setZero();
+                    continue;
+                }   // end if
+
+                if ( w[i] == 0) // Push correspondence rejected so use the pulls only
+                    U.row(i) = pullSum.row(i) / float(pullCnt[i]);
+                else if ( prms.eqPushPull)
+                    U.row(i) = 0.5f * (U.row(i) + pullSum.row(i) / float(pullCnt[i]));
+                else
+                    U.row(i) = (U.row(i) + pullSum.row(i)) / float(1 + pullCnt[i]);
+                w[i] = 1.0f;
+            }   // end for
+        });
+
+        // Robust inlier weights (Gaussian inliers against uniform outliers)
+        const std::vector<float> valid = w;
+        for ( size_t k = 0; k < prms.numInlierIts; ++k)
+        {
+            double sw = 0, swd = 0;
+            for ( size_t i = 0; i < N; ++i)
+            {
+                sw += w[i];
+                swd += w[i] * U.row(i).squaredNorm();
+            }   // end for
+            if ( sw <= 0)
+                break;
+            const float isig2 = float( 3 * sw / std::max( swd, 1e-12)) / 2;  // 1/(2 sigma^2)
+            parallelChunks( N, [&]( size_t i0, size_t i1)
+            {
+                for ( size_t i = i0; i < i1; ++i)
+                {
+                    if ( valid[i] == 0)
+                        continue;
+                    const float g = expf( -U.row(i).squaredNorm() * isig2);
+                    w[i] = g / (g + outp);
+                }   // end for
+            });
+        }   // end for
+        for ( size_t i = 0; i < N; ++i)
+            if ( w[i] < minw)
+                w[i] = 0;
+
+        // Viscous smoothing of the force field (first pass weighted by inlier probability)
+        nbs.smooth( U, S, &w);
+        const size_t nv = anneal( prms.numViscousStart, prms.numViscousEnd, it, totalIts);
+        for ( size_t k = 1; k < nv; ++k)
+        {
+            nbs.smooth( S, tmp);
+            S.swap( tmp);
+        }   // end for
+
+        // Elastic smoothing of the accumulated displacement field
+        D += S;
+        const size_t ne = anneal( prms.numElasticStart, prms.numElasticEnd, it, totalIts);
+        for ( size_t k = 0; k < ne; ++k)
+        {
+            nbs.smooth( D, tmp);
+            D.swap( tmp);
+        }   // end for
+
+        V = V0 + D;
+    }   // end for
+    return true;
+}   // end update
+
+}   // end namespace
+
+
+ViscoElasticRegistration::ViscoElasticRegistration( const MaskRegistration::Params &prms) : _prms(prms) {}
+
+
+MatX3f ViscoElasticRegistration::operator()( const r3d::Mesh &floating, const r3d::Mesh &target, const r3d::KDTree &tkdt,
+                                             const CancelFn &cfn) const
+{
+    assert( floating.hasSequentialIds());
+    assert( target.hasSequentialIds());
+
+    const MatX3f V0 = vertexRows( floating);
+    const MatX3f T = vertexRows( target);
+    const MatX3f TN = calcNormals( target, T);
+    const Neighbourhoods nbs( floating, V0, std::max<size_t>( 1, _prms.smoothK), _prms.sigmaSmooth);
+
+    size_t totalIts = _prms.numUpdateIts;
+    for ( const MaskRegistration::Params::Level &lvl : _prms.levels)
+        totalIts += lvl.numUpdateIts;
+
+    MatX3f D = MatX3f::Zero( V0.rows(), 3);    // Accumulated displacement field
+    size_t it = 0;
+
+    // Coarse levels against sub-sampled target points (keeping the normals from the full resolution surface)
+    for ( const MaskRegistration::Params::Level &lvl : _prms.levels)
+    {
+        const std::vector<int> vidxs = subsampleVertices( target, lvl.cellSize);
+        MatX3f LT( vidxs.size(), 3);
+        MatX3f LTN( vidxs.size(), 3);
+        for ( size_t i = 0; i < vidxs.size(); ++i)
+        {
+            LT.row(i) = T.row(vidxs[i]);
+            LTN.row(i) = TN.row(vidxs[i]);
+        }   // end for
+        const r3d::Mesh::Ptr lmesh = r3d::Mesh::fromVertices( LT);
+        const r3d::KDTree::Ptr lkdt = r3d::KDTree::create( *lmesh);
+        if ( !update( _prms, floating, nbs, V0, D, LT, LTN, *lkdt, it, lvl.numUpdateIts, totalIts, cfn))
+            return MatX3f( 0, 3);
+        it += lvl.numUpdateIts;
+    }   // end for
+
+    // Final correspondence against the full resolution surface
+    if ( !update( _prms, floating, nbs, V0, D, T, TN, tkdt, it, _prms.numUpdateIts, totalIts, cfn))
+        return MatX3f( 0, 3);
+
+    return V0 + D;
+}   // end operator()
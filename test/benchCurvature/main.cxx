@@ -0,0 +1,101 @@
+#include <FileIO/FaceModelXMLFileHandler.h>
+#include <CurvatureMap.h>
+#include <FaceModel.h>
+#include <r3d/Curvature.h>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+using FaceTools::FM;
+using FaceTools::CurvatureMap;
+
+// Tolerances for CurvatureMap agreeing with r3d::Curvature
+static const double MAX_MEAN_NORMAL_DEGS = 1.0;     // Mean angle between vertex normals
+static const double MAX_P99_NORMAL_DEGS = 5.0;      // 99th percentile angle between vertex normals
+static const double MAX_MEAN_CURV_ERROR = 0.25;     // Mean abs difference of |mean curvature| relative to r3d's mean
+
+
+// Compare vertex normals and curvature from CurvatureMap against r3d::Curvature and time both.
+int main( int argc, char *argv[])
+{
+    if ( argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " model.3df [repeats]" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    const int reps = argc > 2 ? std::max( 1, atoi(argv[2])) : 3;
+
+    FaceTools::FileIO::FaceModelXMLFileHandler handler;
+    FM *fm = handler.read( argv[1]);
+    if ( !fm)
+    {
+        std::cerr << argv[1] << ": " << handler.error().toStdString() << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+    const r3d::Mesh &mesh = fm->mesh();
+
+    QElapsedTimer timer;
+    timer.start();
+    r3d::Curvature::Ptr rcurv;
+    for ( int i = 0; i < reps; ++i)
+        rcurv = r3d::Curvature::create( mesh);
+    const double r3dms = double(timer.nsecsElapsed()) * 1e-6 / reps;
+
+    timer.restart();
+    CurvatureMap::Ptr cmap;
+    for ( int i = 0; i < reps; ++i)
+        cmap = CurvatureMap::create( mesh);
+    const double cmapms = double(timer.nsecsElapsed()) * 1e-6 / reps;
+
+    const FaceTools::MatX3f &rnrms = rcurv->vertexNormals();
+    std::vector<double> degs;
+    double sumRH = 0, sumHErr = 0;
+    for ( int vidx : mesh.vtxIds())
+    {
+        const FaceTools::Vec3f rn = rnrms.row(vidx).transpose();
+        const double cosa = std::max( -1.0, std::min( 1.0, double( rn.dot( cmap->vertexNormal(vidx)))));
+        degs.push_back( std::acos( cosa) * 180.0 / EIGEN_PI);
+
+        float k1, k2;
+        rcurv->vertexPC1( vidx, k1);
+        rcurv->vertexPC2( vidx, k2);
+        const double rh = std::fabs( 0.5 * (k1 + k2));
+        sumRH += rh;
+        sumHErr += std::fabs( rh - std::fabs( cmap->meanCurvature(vidx)));
+    }   // end for
+
+    const size_t n = degs.size();
+    std::sort( degs.begin(), degs.end());
+    double meanDegs = 0;
+    for ( double d : degs)
+        meanDegs += d;
+    meanDegs /= std::max<size_t>( 1, n);
+    const double p99Degs = n > 0 ? degs[std::min( n-1, size_t(0.99 * n))] : 0;
+    const double curvErr = sumRH > 0 ? sumHErr / sumRH : 0;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << n << " vertices x " << reps << " repeats" << std::endl
+              << "  r3d::Curvature: " << std::setw(10) << r3dms << " ms" << std::endl
+              << "  CurvatureMap:   " << std::setw(10) << cmapms << " ms" << std::endl
+              << "  Speedup: " << r3dms / cmapms << "x" << std::endl
+              << "  Normal angle (degs) mean: " << meanDegs << ", 99th percentile: " << p99Degs << std::endl
+              << "  Relative mean curvature error: " << std::setprecision(3) << curvErr << std::endl;
+    delete fm;
+
+    bool ok = true;
+    if ( meanDegs > MAX_MEAN_NORMAL_DEGS || p99Degs > MAX_P99_NORMAL_DEGS)
+    {
+        std::cerr << "[ERROR] Vertex normals differ from r3d::Curvature by more than "
+                  << MAX_MEAN_NORMAL_DEGS << " degs mean or " << MAX_P99_NORMAL_DEGS << " degs 99th percentile!" << std::endl;
+        ok = false;
+    }   // end if
+    if ( curvErr > MAX_MEAN_CURV_ERROR)
+    {
+        std::cerr << "[ERROR] Mean curvature differs from r3d::Curvature by more than " << MAX_MEAN_CURV_ERROR << "!" << std::endl;
+        ok = false;
+    }   // end if
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}   // end main
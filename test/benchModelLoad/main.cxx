@@ -0,0 +1,60 @@
+#include <FileIO/FaceModelXMLFileHandler.h>
+#include <FileIO/FaceModelBinaryFileHandler.h>
+#include <QElapsedTimer>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+using FaceTools::FM;
+using namespace FaceTools::FileIO;
+
+
+// Returns the mean milliseconds taken to read the given file or a negative value on failure.
+double timeLoad( FaceModelFileHandler &handler, const QString &fpath, int reps, size_t &nvtxs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for ( int i = 0; i < reps; ++i)
+    {
+        FM *fm = handler.read( fpath);
+        if ( !fm)
+        {
+            std::cerr << fpath.toStdString() << ": " << handler.error().toStdString() << std::endl;
+            return -1;
+        }   // end if
+        nvtxs = fm->mesh().numVtxs();
+        delete fm;
+    }   // end for
+    return double(timer.nsecsElapsed()) * 1e-6 / reps;
+}   // end timeLoad
+
+
+// Benchmark model load times from 3DF against the binary format (as written by convert3DF).
+int main( int argc, char *argv[])
+{
+    if ( argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " model.3df model.3dfb [repeats]" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    const int reps = argc > 3 ? std::max( 1, atoi(argv[3])) : 5;
+
+    FaceModelXMLFileHandler xmlHandler;
+    FaceModelBinaryFileHandler binHandler;
+    size_t nv0 = 0;
+    size_t nv1 = 0;
+    const double xmlms = timeLoad( xmlHandler, argv[1], reps, nv0);
+    const double binms = timeLoad( binHandler, argv[2], reps, nv1);
+    if ( xmlms < 0 || binms < 0)
+        return EXIT_FAILURE;
+
+    if ( nv0 != nv1)
+        std::cerr << "[WARN] Vertex counts differ (" << nv0 << " vs " << nv1 << ")!" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << nv0 << " vertices x " << reps << " repeats" << std::endl
+              << "  3DF:    " << std::setw(8) << xmlms << " ms/load" << std::endl
+              << "  Binary: " << std::setw(8) << binms << " ms/load" << std::endl
+              << "  Speedup: " << std::setprecision(2) << xmlms / binms << "x" << std::endl;
+    return EXIT_SUCCESS;
+}   // end main
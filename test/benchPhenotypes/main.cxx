@@ -0,0 +1,104 @@
+#include <FileIO/FaceModelXMLFileHandler.h>
+#include <Metric/PhenotypeManager.h>
+#include <Metric/MetricManager.h>
+#include <Metric/StatisticsManager.h>
+#include <FaceModel.h>
+#include <QElapsedTimer>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+using FaceTools::FM;
+using FaceTools::IntSet;
+using PM = FaceTools::Metric::PhenotypeManager;
+using FaceTools::Metric::Phenotype;
+
+
+// Returns the seconds taken to discover the phenotypes of the given models reps times.
+double timeDiscover( const std::vector<const FM*> &fms, int reps, std::vector<IntSet> &dids)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for ( int i = 0; i < reps; ++i)
+        dids = PM::discover( fms);
+    return double(timer.nsecsElapsed()) * 1e-9;
+}   // end timeDiscover
+
+
+// Benchmark phenotype discovery with natively compiled criteria against evaluating all criteria with Lua.
+int main( int argc, char *argv[])
+{
+    if ( argc < 6)
+    {
+        std::cerr << "Usage: " << argv[0] << " metricsDir statsDir hpoDir repeats model.3df [model.3df ...]" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    if ( FaceTools::Metric::MetricManager::load( argv[1]) <= 0
+            || FaceTools::Metric::StatisticsManager::load( argv[2]) <= 0
+            || PM::load( argv[3]) <= 0)
+    {
+        std::cerr << "Unable to load metrics, statistics and HPO terms!" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    const int reps = std::max( 1, atoi(argv[4]));
+
+    FaceTools::FileIO::FaceModelXMLFileHandler handler;
+    std::vector<const FM*> fms;
+    for ( int i = 5; i < argc; ++i)
+    {
+        FM *fm = handler.read( argv[i]);
+        if ( !fm)
+        {
+            std::cerr << argv[i] << ": " << handler.error().toStdString() << std::endl;
+            return EXIT_FAILURE;
+        }   // end if
+        fms.push_back( fm);
+    }   // end for
+
+    size_t ncompiled = 0;
+    for ( int id : PM::ids())
+        if ( PM::phenotype(id)->isCompiled())
+            ncompiled++;
+
+    std::vector<IntSet> luaIds, nativeIds;
+    Phenotype::setUseCompiled( false);
+    const double luaSecs = timeDiscover( fms, reps, luaIds);
+    Phenotype::setUseCompiled( true);
+    const double nativeSecs = timeDiscover( fms, reps, nativeIds);
+
+    // Compiled criteria must give exactly the same results as Lua
+    int nmismatch = 0;
+    for ( size_t i = 0; i < fms.size(); ++i)
+    {
+        for ( int id : PM::ids())
+        {
+            const bool inLua = luaIds[i].count(id) > 0;
+            if ( inLua != (nativeIds[i].count(id) > 0))
+            {
+                std::cerr << "[ERROR] " << PM::formattedId(id).toStdString() << " (" << PM::name(id).toStdString() << ")"
+                          << (inLua ? " found by Lua but not compiled criteria" : " found by compiled criteria but not Lua")
+                          << " for " << argv[5+i] << std::endl;
+                nmismatch++;
+            }   // end if
+        }   // end for
+    }   // end for
+
+    const double nevals = double( reps * fms.size() * PM::size());
+    std::cout << std::fixed << std::setprecision(1)
+              << PM::size() << " HPO terms (" << ncompiled << " compiled) x " << fms.size()
+              << " models x " << reps << " repeats" << std::endl
+              << "  Lua:      " << std::setw(12) << nevals / luaSecs << " phenotypes/sec" << std::endl
+              << "  Compiled: " << std::setw(12) << nevals / nativeSecs << " phenotypes/sec" << std::endl
+              << "  Speedup: " << std::setprecision(2) << luaSecs / nativeSecs << "x" << std::endl;
+
+    for ( const FM *fm : fms)
+        delete fm;
+
+    if ( nmismatch > 0)
+    {
+        std::cerr << nmismatch << " mismatched results between Lua and compiled criteria!" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+    return EXIT_SUCCESS;
+}   // end main
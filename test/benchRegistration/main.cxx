@@ -0,0 +1,119 @@
+#include <FileIO/FaceModelManager.h>
+#include <FileIO/FaceModelXMLFileHandler.h>
+#include <FileIO/FaceModelBinaryFileHandler.h>
+#include <MaskRegistration.h>
+#include <FaceModel.h>
+#include <QElapsedTimer>
+#include <QThread>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+using FaceTools::FM;
+using FaceTools::Vec3f;
+using FMM = FaceTools::FileIO::FaceModelManager;
+using MR = FaceTools::MaskRegistration;
+
+
+namespace {
+
+// Landmark positions on a registered mask (keyed by lateral and landmark ID).
+std::vector<Vec3f> landmarkPositions( const r3d::Mesh &mask)
+{
+    std::vector<Vec3f> pos;
+    const MR::MaskPtr mdata = MR::maskData();
+    for ( const auto *lmks : {&mdata->lmksL, &mdata->lmksM, &mdata->lmksR})
+        for ( const auto &p : *lmks)
+            pos.push_back( mask.fromBarycentric( p.second.first, p.second.second));
+    return pos;
+}   // end landmarkPositions
+
+
+double timeRegistration( const FM *fm, const MR::Params &prms, int reps, r3d::Mesh::Ptr &mask)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for ( int i = 0; i < reps; ++i)
+        mask = MR::registerMask( fm, prms);
+    return double(timer.nsecsElapsed()) * 1e-6 / reps;
+}   // end timeRegistration
+
+}   // end namespace
+
+
+// Benchmark MaskRegistration::registerMask using the multi-threaded presets reporting mean time and
+// the mean and maximum deviation of the mask landmarks from those found using the default parameters
+// (single threaded rNonRigid at full resolution). Fails if any preset's maximum landmark deviation
+// exceeds the tolerance (model units, default 0.5).
+int main( int argc, char *argv[])
+{
+    if ( argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " mask.3df model.3df [repeats] [max landmark deviation]" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    const int reps = argc > 3 ? std::max( 1, atoi(argv[3])) : 3;
+    const double maxTol = argc > 4 ? atof(argv[4]) : 0.5;
+
+    FMM::add( new FaceTools::FileIO::FaceModelXMLFileHandler);
+    FMM::add( new FaceTools::FileIO::FaceModelBinaryFileHandler);
+    MR::setCacheDir( "");   // Time the registrations themselves
+    if ( !MR::setMask( argv[1]))
+    {
+        std::cerr << "Unable to set mask from " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    // Mask loads asynchronously
+    for ( int i = 0; i < 600 && !MR::maskLoaded(); ++i)
+        QThread::msleep(100);
+    if ( !MR::maskLoaded())
+    {
+        std::cerr << "Timed out waiting for mask to load!" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    // Models saved with a mask are already aligned with it
+    FM *fm = FMM::read( argv[2]);
+    if ( !fm || !fm->mesh().hasSequentialIds())
+    {
+        std::cerr << "Unable to read in FaceModel with sequential vertex IDs from " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    r3d::Mesh::Ptr mask;
+    const double refms = timeRegistration( fm, MR::Params(), reps, mask);
+    const std::vector<Vec3f> reflmks = landmarkPositions( *mask);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(10) << "default" << std::right << std::setw(10) << refms << " ms" << std::endl;
+
+    int nfailed = 0;
+    const std::pair<const char*, MR::Params> presets[] = { {"fast", MR::Params::fast()},
+                                                            {"standard", MR::Params::standard()},
+                                                            {"precise", MR::Params::precise()}};
+    for ( const auto &p : presets)
+    {
+        const double ms = timeRegistration( fm, p.second, reps, mask);
+        const std::vector<Vec3f> lmks = landmarkPositions( *mask);
+        double meanDev = 0, maxDev = 0;
+        for ( size_t i = 0; i < lmks.size(); ++i)
+        {
+            const double d = (lmks[i] - reflmks[i]).norm();
+            meanDev += d;
+            maxDev = std::max( maxDev, d);
+        }   // end for
+        meanDev /= std::max<size_t>( 1, lmks.size());
+
+        std::cout << std::left << std::setw(10) << p.first << std::right << std::setw(10) << ms << " ms ("
+                  << refms / ms << "x); landmark deviation mean " << meanDev << " max " << maxDev << std::endl;
+        if ( maxDev > maxTol)
+        {
+            std::cerr << "[FAIL] " << p.first << " maximum landmark deviation exceeds " << maxTol << std::endl;
+            nfailed++;
+        }   // end if
+    }   // end for
+
+    FMM::close( fm);
+    return nfailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}   // end main
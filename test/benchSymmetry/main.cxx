@@ -0,0 +1,67 @@
+#include <FileIO/FaceModelManager.h>
+#include <FileIO/FaceModelXMLFileHandler.h>
+#include <FileIO/FaceModelBinaryFileHandler.h>
+#include <FaceModelSymmetry.h>
+#include <MaskRegistration.h>
+#include <FaceModel.h>
+#include <QElapsedTimer>
+#include <QThread>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+using FaceTools::FM;
+using FMM = FaceTools::FileIO::FaceModelManager;
+
+
+// Benchmark FaceModelSymmetry::add reporting the number of model vertices processed per second.
+int main( int argc, char *argv[])
+{
+    if ( argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " mask.3df model.3df [repeats]" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    const int reps = argc > 3 ? std::max( 1, atoi(argv[3])) : 10;
+
+    FMM::add( new FaceTools::FileIO::FaceModelXMLFileHandler);
+    FMM::add( new FaceTools::FileIO::FaceModelBinaryFileHandler);
+    if ( !FaceTools::MaskRegistration::setMask( argv[1]))
+    {
+        std::cerr << "Unable to set mask from " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    // Mask loads asynchronously
+    for ( int i = 0; i < 600 && !FaceTools::MaskRegistration::maskLoaded(); ++i)
+        QThread::msleep(100);
+    if ( !FaceTools::MaskRegistration::maskLoaded())
+    {
+        std::cerr << "Timed out waiting for mask to load!" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    FM *fm = FMM::read( argv[2]);
+    if ( !fm || !fm->hasMask())
+    {
+        std::cerr << "Unable to read in FaceModel with a mask from " << argv[2] << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    const size_t nvtxs = fm->mesh().numVtxs();
+    QElapsedTimer timer;
+    timer.start();
+    for ( int i = 0; i < reps; ++i)
+    {
+        FaceTools::FaceModelSymmetry::purge( fm);
+        FaceTools::FaceModelSymmetry::add( fm);
+    }   // end for
+    const double secs = double(timer.nsecsElapsed()) * 1e-9;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << nvtxs << " vertices x " << reps << " repeats in " << secs << " secs: "
+              << double(nvtxs * reps) / secs << " vertices/sec" << std::endl;
+
+    FMM::close( fm);
+    return EXIT_SUCCESS;
+}   // end main
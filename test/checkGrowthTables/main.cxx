@@ -0,0 +1,93 @@
+#include <Metric/MetricManager.h>
+#include <Metric/StatisticsManager.h>
+#include <Metric/GrowthTable.h>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <cstdlib>
+#include <cmath>
+using MM = FaceTools::Metric::MetricManager;
+using FaceTools::Metric::GrowthData;
+using FaceTools::Metric::GrowthTable;
+
+
+// Returns the largest absolute difference in z-score between the lookup table and the distribution
+// itself for the given number of random ages (either side of the age domain to check clamping) and
+// values (within three standard deviations of the mean at that age).
+double maxZScoreError( const GrowthTable &table, const rlib::RSD &rsd, int nsamples, std::mt19937 &rng)
+{
+    // Ages are clamped to the domain as MetricValue did before the tables were used
+    const double tmin = rsd.tmin();
+    const double tmax = int(rsd.tmax() + 0.5);
+    std::uniform_real_distribution<double> ageDist( tmin - 2, tmax + 2);
+    std::uniform_real_distribution<double> zDist( -3, 3);
+
+    double maxErr = 0;
+    for ( int i = 0; i < nsamples; ++i)
+    {
+        const double age = ageDist( rng);
+        const double t = std::max( tmin, std::min( age, tmax));
+        const double v = rsd.mval( t) + zDist( rng) * rsd.zval( t);
+        const double err = std::fabs( table.zscore( float(age), float(v)) - rsd.zscore( t, v));
+        maxErr = std::max( maxErr, err);
+    }   // end for
+    return maxErr;
+}   // end maxZScoreError
+
+
+// Check that z-scores from the precomputed growth curve lookup tables match those calculated directly
+// from the distributions over random ages and values for every dimension of every loaded growth curve.
+int main( int argc, char *argv[])
+{
+    if ( argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " metricsDir statsDir [samples] [tolerance]" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    if ( MM::load( argv[1]) <= 0 || FaceTools::Metric::StatisticsManager::load( argv[2]) <= 0)
+    {
+        std::cerr << "Unable to load metrics and statistics!" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    const int nsamples = argc > 3 ? std::max( 1, atoi(argv[3])) : 10000;
+    const double tol = argc > 4 ? atof(argv[4]) : 1e-3;
+
+    std::mt19937 rng( 42);  // Fixed seed so failures can be reproduced
+    int nchecked = 0;
+    int nfailed = 0;
+    double maxErr = 0;
+    for ( int mid : MM::ids())
+    {
+        const FaceTools::Metric::MC::Ptr mc = MM::metric( mid);
+        for ( const GrowthData *gd : mc->growthData().all())
+        {
+            for ( size_t d = 0; d < gd->dims(); ++d)
+            {
+                if ( !gd->rsd(d))
+                    continue;
+                const double err = maxZScoreError( gd->table(d), *gd->rsd(d), nsamples, rng);
+                maxErr = std::max( maxErr, err);
+                nchecked++;
+                if ( err > tol)
+                {
+                    std::cerr << "[ERROR] " << mc->name().toStdString() << " (metric " << mid << ") "
+                              << gd->source().toStdString() << " sex " << int(gd->sex()) << " ethnicity " << gd->ethnicity()
+                              << " dimension " << d << ": max z-score error " << err << std::endl;
+                    nfailed++;
+                }   // end if
+            }   // end for
+        }   // end for
+    }   // end for
+
+    std::cout << nchecked << " growth curve dimensions checked at " << nsamples << " samples each; max z-score error "
+              << std::scientific << std::setprecision(3) << maxErr << " (tolerance " << tol << ")" << std::endl;
+    if ( nfailed > 0)
+    {
+        std::cerr << nfailed << " exceed the tolerance!" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+    return EXIT_SUCCESS;
+}   // end main
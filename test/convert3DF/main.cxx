@@ -0,0 +1,46 @@
+#include <FileIO/FaceModelXMLFileHandler.h>
+#include <FileIO/FaceModelBinaryFileHandler.h>
+#include <QFileInfo>
+#include <QDir>
+#include <iostream>
+#include <cstdlib>
+using FaceTools::FM;
+using namespace FaceTools::FileIO;
+
+
+// Convert 3DF files to the binary format writing each alongside its source.
+int main( int argc, char *argv[])
+{
+    if ( argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " model.3df [model.3df ...]" << std::endl;
+        return EXIT_FAILURE;
+    }   // end if
+
+    FaceModelXMLFileHandler xmlHandler;
+    FaceModelBinaryFileHandler binHandler;
+    int nfailed = 0;
+    for ( int i = 1; i < argc; ++i)
+    {
+        const QFileInfo finfo( argv[i]);
+        const QString outpath = finfo.dir().filePath( finfo.completeBaseName() + "." + BIN_FILE_EXTENSION);
+        FM *fm = xmlHandler.read( argv[i]);
+        if ( !fm)
+        {
+            std::cerr << argv[i] << ": " << xmlHandler.error().toStdString() << std::endl;
+            nfailed++;
+            continue;
+        }   // end if
+
+        if ( binHandler.write( fm, outpath))
+            std::cout << argv[i] << " --> " << outpath.toStdString() << std::endl;
+        else
+        {
+            std::cerr << outpath.toStdString() << ": " << binHandler.error().toStdString() << std::endl;
+            nfailed++;
+        }   // end else
+        delete fm;
+    }   // end for
+
+    return nfailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}   // end main